@@ -180,24 +180,77 @@ bool account_t::remove_post(post_t * post)
   return true;
 }
 
-string account_t::fullname() const
+const string& account_t::fullname() const
 {
-  if (! _fullname.empty()) {
-    return _fullname;
-  } else {
-    const account_t *   first    = this;
-    string              fullname = name;
+  // Build on the parent's name, which is then kept as well, so that each
+  // name in the tree is put together only once
+  if (_fullname.empty()) {
+    if (parent) {
+      const string& parent_name(parent->fullname());
+      if (! parent_name.empty()) {
+        _fullname.reserve(parent_name.length() + 1 + name.length());
+        _fullname = parent_name;
+        _fullname += ':';
+        _fullname += name;
+        return _fullname;
+      }
+    }
+    _fullname = name;
+  }
+  return _fullname;
+}
 
-    while (first->parent) {
-      first = first->parent;
-      if (! first->name.empty())
-        fullname = first->name + ":" + fullname;
+void account_t::set_name(const string& _name)
+{
+  if (parent) {
+    accounts_map::iterator i = parent->accounts.find(name);
+    if (i != parent->accounts.end() && (*i).second == this) {
+      parent->accounts.erase(i);
+      parent->accounts.insert(accounts_map::value_type(_name, this));
     }
+  }
+  name = _name;
+  clear_fullname();
+}
+
+void account_t::clear_fullname() const
+{
+  // Full names, and the masks matched against them, follow from the
+  // names of parents, so every account beneath this one is cleared too
+  _fullname.clear();
+  _mask_results.clear();
+
+  foreach (const accounts_map::value_type& pair, accounts)
+    pair.second->clear_fullname();
+}
 
-    _fullname = fullname;
+namespace {
+  typedef std::map<string, std::size_t> mask_index_map;
+
+  mask_index_map mask_indices;
+}
 
-    return fullname;
+std::size_t account_t::mask_index(const mask_t& mask)
+{
+  // Masks with the same pattern match the same names, so they share an
+  // index, and with it the results remembered by each account.
+  std::pair<mask_index_map::iterator, bool> result =
+    mask_indices.insert(mask_index_map::value_type(mask.str(),
+                                                   mask_indices.size()));
+  return (*result.first).second;
+}
+
+bool account_t::fullname_matches(const mask_t& mask,
+                                 const std::size_t index) const
+{
+  if (_mask_results.size() <= index * 2)
+    _mask_results.resize(index * 2 + 2);
+
+  if (! _mask_results[index * 2]) {
+    _mask_results[index * 2]     = true;
+    _mask_results[index * 2 + 1] = mask.match(fullname());
   }
+  return _mask_results[index * 2 + 1];
 }
 
 string account_t::partial_name(bool flat) const
@@ -378,6 +431,8 @@ namespace {
     }
     return true;
   }
+
+  symbol_cache_t account_functions;
 }
 
 expr_t::ptr_op_t account_t::lookup(const symbol_t::kind_t kind,
@@ -386,6 +441,16 @@ expr_t::ptr_op_t account_t::lookup(const symbol_t::kind_t kind,
   if (kind != symbol_t::FUNCTION)
     return NULL;
 
+  expr_t::ptr_op_t def;
+  if (! account_functions.find(fn_name, def)) {
+    def = lookup_function(fn_name);
+    account_functions.remember(fn_name, def);
+  }
+  return def;
+}
+
+expr_t::ptr_op_t account_t::lookup_function(const string& fn_name)
+{
   switch (fn_name[0]) {
   case 'a':
     if (fn_name[1] == '\0' || fn_name == "amount")
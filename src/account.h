@@ -71,7 +71,24 @@ public:
   optional<deferred_posts_map_t> deferred_posts;
   optional<expr_t>               value_expr;
 
+  // A number for this account, dense within the tree of accounts it
+  // belongs to, so that tables about accounts may be vectors indexed by
+  // it.  The root, usually a journal's master account, has the id 0
+  // and keeps the next id to hand out in _next_id.  Temporary accounts
+  // do not take ids from the root; temporaries_t numbers them after
+  // the root's own accounts and starts again when cleared, so their ids
+  // may be shared with other temporaries, and a parentless temporary is
+  // the root of a tree of its own.  Tables mixing accounts from more
+  // than one tree must check which account a slot holds.
+  std::size_t                    id;
+  std::size_t                    _next_id;
+
   mutable string   _fullname;
+
+  // Results of matching fullname() against account masks: the bits at
+  // 2n and 2n + 1 say whether the mask with index n (see mask_index())
+  // has been tried, and whether it matched.
+  mutable std::vector<bool> _mask_results;
 #if DOCUMENT_MODEL
   mutable void * data;
 #endif
@@ -81,7 +98,8 @@ public:
             const optional<string>& _note   = none)
     : supports_flags<>(), scope_t(), parent(_parent),
       name(_name), note(_note),
-      depth(static_cast<unsigned short>(parent ? parent->depth + 1 : 0))
+      depth(static_cast<unsigned short>(parent ? parent->depth + 1 : 0)),
+      id(parent ? parent->root()->_next_id++ : 0), _next_id(1)
 #if DOCUMENT_MODEL
       , data(NULL)
 #endif
@@ -94,7 +112,8 @@ public:
       name(other.name),
       note(other.note),
       depth(other.depth),
-      accounts(other.accounts)
+      accounts(other.accounts),
+      id(other.id), _next_id(other._next_id)
 #if DOCUMENT_MODEL
       , data(NULL)
 #endif
@@ -110,9 +129,22 @@ public:
   operator string() const {
     return fullname();
   }
-  string fullname() const;
+  const string& fullname() const;
   string partial_name(bool flat = false) const;
 
+  void set_name(const string& _name);
+  void clear_fullname() const;
+
+  account_t * root() {
+    account_t * top = this;
+    while (top->parent)
+      top = top->parent;
+    return top;
+  }
+
+  static std::size_t mask_index(const mask_t& mask);
+  bool fullname_matches(const mask_t& mask, const std::size_t index) const;
+
   void add_account(account_t * acct) {
     accounts.insert(accounts_map::value_type(acct->name, acct));
   }
@@ -151,6 +183,7 @@ public:
 
   virtual expr_t::ptr_op_t lookup(const symbol_t::kind_t kind,
                                   const string& name);
+  expr_t::ptr_op_t lookup_function(const string& name);
 
   bool valid() const;
 
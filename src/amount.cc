@@ -46,39 +46,320 @@ bool amount_t::stream_fullstrings = false;
 // efficiency, and are reused over and over again.
 static mpz_t  temp;
 static mpq_t  tempq;
+static mpq_t  tempqv;           // for reading small quantities
 static mpfr_t tempf;
 static mpfr_t tempfb;
 static mpfr_t tempfnum;
 static mpfr_t tempfden;
 #endif
 
+namespace {
+  /**
+   * @brief A slab allocator for quantities and their GMP limbs.
+   *
+   * Amounts create and destroy a great many small objects: a bigint_t for
+   * every quantity that is copied on write, and the limbs of every mpq_t.
+   * Blocks of up to max_size bytes are carved out of large chunks and
+   * recycled through one free list per size class; anything larger goes
+   * to the heap.  GMP is pointed at this pool by amount_t::initialize(),
+   * and amount_t::shutdown() drops all of its chunks at once if nothing
+   * allocated from them is still alive.
+   *
+   * Like the temporaries above, the pool is not synchronized.  It holds
+   * only plain data, so that it is usable before static constructors run.
+   */
+  struct quantity_pool_t
+  {
+    static const std::size_t granularity = 16;
+    static const std::size_t classes     = 16;
+    static const std::size_t max_size    = granularity * classes;
+    static const std::size_t chunk_size  = 64 * 1024;
+
+    struct block_t { block_t * next; };
+
+    block_t *   free_lists[classes];
+    block_t *   chunks;         // each chunk begins with a link to the next
+    char *      chunk_cur;
+    char *      chunk_end;
+    std::size_t live;
+    std::size_t chunk_count;
+
+    static std::size_t class_of(const std::size_t size) {
+      return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    void * allocate(const std::size_t size) {
+      if (size > max_size)
+        return std::malloc(size);
+
+      const std::size_t index = class_of(size);
+      ++live;
+      if (block_t * block = free_lists[index]) {
+        free_lists[index] = block->next;
+        return block;
+      }
+
+      const std::size_t block_size = (index + 1) * granularity;
+      if (static_cast<std::size_t>(chunk_end - chunk_cur) < block_size) {
+        char * chunk = static_cast<char *>(std::malloc(chunk_size));
+        if (! chunk) {
+          --live;
+          return NULL;
+        }
+        reinterpret_cast<block_t *>(chunk)->next = chunks;
+        chunks    = reinterpret_cast<block_t *>(chunk);
+        chunk_cur = chunk + granularity;
+        chunk_end = chunk + chunk_size;
+        ++chunk_count;
+      }
+      void * block = chunk_cur;
+      chunk_cur += block_size;
+      return block;
+    }
+
+    void deallocate(void * ptr, const std::size_t size) {
+      if (! ptr)
+        return;
+      if (size > max_size) {
+        std::free(ptr);
+        return;
+      }
+      const std::size_t index = class_of(size);
+      block_t * block   = static_cast<block_t *>(ptr);
+      block->next       = free_lists[index];
+      free_lists[index] = block;
+      --live;
+    }
+
+    void * reallocate(void * ptr, const std::size_t old_size,
+                      const std::size_t new_size) {
+      if (old_size > max_size && new_size > max_size)
+        return std::realloc(ptr, new_size);
+      if (old_size <= max_size && new_size <= max_size &&
+          class_of(old_size) == class_of(new_size))
+        return ptr;
+
+      void * block = allocate(new_size);
+      if (block) {
+        std::memcpy(block, ptr, std::min(old_size, new_size));
+        deallocate(ptr, old_size);
+      }
+      return block;
+    }
+
+    void release() {
+      DEBUG("amount.pool", "Quantity pool has " << chunk_count
+            << " chunks, with " << live << " blocks still in use");
+      if (live > 0)
+        return;
+
+      while (chunks) {
+        block_t * next = chunks->next;
+        std::free(chunks);
+        chunks = next;
+      }
+      std::memset(free_lists, 0, sizeof(free_lists));
+      chunk_cur   = NULL;
+      chunk_end   = NULL;
+      chunk_count = 0;
+    }
+  };
+
+  quantity_pool_t quantity_pool;
+  bool            gmp_uses_pool = false;
+
+  // GMP cannot unwind an exception, so running out of memory is fatal
+  // here, just as it is with GMP's own allocator.
+  void * gmp_allocate(std::size_t size) {
+    void * ptr = quantity_pool.allocate(size);
+    if (! ptr) {
+      std::cerr << _("Error: Out of memory for amount quantities") << std::endl;
+      std::abort();
+    }
+    return ptr;
+  }
+  void * gmp_reallocate(void * ptr, std::size_t old_size,
+                        std::size_t new_size) {
+    void * block = quantity_pool.reallocate(ptr, old_size, new_size);
+    if (! block) {
+      std::cerr << _("Error: Out of memory for amount quantities") << std::endl;
+      std::abort();
+    }
+    return block;
+  }
+  void gmp_deallocate(void * ptr, std::size_t size) {
+    quantity_pool.deallocate(ptr, size);
+  }
+
+  // Strings returned by GMP must be given back to its allocator.
+  void gmp_free_str(char * str) {
+    void (*free_func)(void *, std::size_t);
+    mp_get_memory_functions(NULL, NULL, &free_func);
+    free_func(str, std::strlen(str) + 1);
+  }
+}
+
 struct amount_t::bigint_t : public supports_flags<>
 {
 #define BIGINT_BULK_ALLOC 0x01
 #define BIGINT_KEEP_PREC  0x02
 
-  mpq_t          val;
-  precision_t    prec;
-  uint_least32_t refc;
+  // Most quantities are decimal numbers of modest size, such as $12.34.
+  // These are held as a 64-bit mantissa scaled by a power of ten, and are
+  // only turned into an mpq_t (which is not initialized until then) when
+  // an operation would overflow, divides, or needs GMP for some other
+  // reason.  The value is the same either way; only its form changes,
+  // which is why these members may change even in a const bigint_t.
+#define BIGINT_MAX_SCALE 18
+
+  mutable mpq_t   val;
+  mutable int64_t mant;
+  mutable uint8_t scale;
+  mutable bool    small;
+  precision_t     prec;
+  uint_least32_t  refc;
 
-#define MP(bigint) ((bigint)->val)
+#define MP(bigint) ((bigint)->mp())
 
-  bigint_t() : prec(0), refc(1) {
-    mpq_init(val);
+  bigint_t() : mant(0), scale(0), small(true), prec(0), refc(1) {
     TRACE_CTOR(bigint_t, "");
   }
   bigint_t(const bigint_t& other)
     : supports_flags<>(static_cast<uint_least8_t>
                        (other.flags() & ~BIGINT_BULK_ALLOC)),
+      mant(other.mant), scale(other.scale), small(other.small),
       prec(other.prec), refc(1) {
-    mpq_init(val);
-    mpq_set(val, other.val);
+    if (! small) {
+      mpq_init(val);
+      mpq_set(val, other.val);
+    }
     TRACE_CTOR(bigint_t, "copy");
   }
   ~bigint_t() {
     TRACE_DTOR(bigint_t);
     assert(refc == 0);
-    mpq_clear(val);
+    if (! small)
+      mpq_clear(val);
+  }
+
+  static void * operator new(std::size_t size) {
+    if (void * ptr = quantity_pool.allocate(size))
+      return ptr;
+    throw std::bad_alloc();
+  }
+  static void operator delete(void * ptr, std::size_t size) {
+    quantity_pool.deallocate(ptr, size);
+  }
+
+  static void set_mpz(mpz_t z, const int64_t n) {
+    uint64_t u = n < 0 ? - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+    mpz_import(z, 1, 1, sizeof(u), 0, 0, &u);
+    if (n < 0)
+      mpz_neg(z, z);
+  }
+
+  void set_mpq(mpq_t q) const {
+    set_mpz(mpq_numref(q), mant);
+    mpz_ui_pow_ui(mpq_denref(q), 10, scale);
+    mpq_canonicalize(q);
+  }
+
+  // Returns the value as an mpq_t which may be modified, converting the
+  // quantity to that form for good.
+  mpq_ptr mp() const {
+    if (small) {
+      mpq_init(val);
+      set_mpq(val);
+      small = false;
+    }
+    return val;
+  }
+
+  // Returns the value as an mpq_t for reading only, using SCRATCH rather
+  // than converting the quantity if it is small.
+  mpq_ptr view(mpq_t scratch) const {
+    if (small) {
+      set_mpq(scratch);
+      return scratch;
+    }
+    return val;
+  }
+
+  void set_small(const int64_t m, const uint8_t s) {
+    if (! small) {
+      mpq_clear(val);
+      small = true;
+    }
+    mant  = m;
+    scale = s;
+  }
+
+  static bool scale_up(int64_t& m, const int by) {
+    static const int64_t powers[BIGINT_MAX_SCALE + 1] = {
+      1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+      100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+      1000000000000LL, 10000000000000LL, 100000000000000LL,
+      1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+      1000000000000000000LL
+    };
+    if (by == 0)
+      return true;
+    const int64_t p = powers[by];
+    if (m > INT64_MAX / p || m < INT64_MIN / p)
+      return false;
+    m *= p;
+    return true;
+  }
+
+  // Bring two small quantities to a common scale.  Returns false if that
+  // cannot be done in 64 bits.
+  bool align(const bigint_t& other, int64_t& a, int64_t& b, uint8_t& s) const {
+    if (! small || ! other.small)
+      return false;
+    a = mant;
+    b = other.mant;
+    s = std::max(scale, other.scale);
+    return scale_up(a, s - scale) && scale_up(b, s - other.scale);
+  }
+
+  bool small_add(const bigint_t& other, const bool subtract) {
+    int64_t a, b;
+    uint8_t s;
+    if (! align(other, a, b, s))
+      return false;
+    if (subtract) {
+      if (b == INT64_MIN)
+        return false;
+      b = -b;
+    }
+    if ((b > 0 && a > INT64_MAX - b) || (b < 0 && a < INT64_MIN - b))
+      return false;
+    set_small(a + b, s);
+    return true;
+  }
+
+  bool small_compare(const bigint_t& other, int& result) const {
+    int64_t a, b;
+    uint8_t s;
+    if (! align(other, a, b, s))
+      return false;
+    result = a < b ? -1 : (a > b ? 1 : 0);
+    return true;
+  }
+
+  bool small_multiply(const bigint_t& other) {
+    if (! small || ! other.small || scale + other.scale > BIGINT_MAX_SCALE)
+      return false;
+    int64_t a = mant, b = other.mant;
+    if (a != 0 && b != 0) {
+      if (a == INT64_MIN || b == INT64_MIN)
+        return false;
+      int64_t abs_a = a < 0 ? -a : a, abs_b = b < 0 ? -b : b;
+      if (abs_a > INT64_MAX / abs_b)
+        return false;
+    }
+    set_small(a * b, static_cast<uint8_t>(scale + other.scale));
+    return true;
   }
 
   bool valid() const {
@@ -91,6 +372,10 @@ struct amount_t::bigint_t : public supports_flags<>
             "amount_t::bigint_t: flags() & ~(BULK_ALLOC | KEEP_PREC)");
       return false;
     }
+    if (small && scale > BIGINT_MAX_SCALE) {
+      DEBUG("ledger.validate", "amount_t::bigint_t: scale > MAX_SCALE");
+      return false;
+    }
     return true;
   }
 };
@@ -111,7 +396,7 @@ namespace {
       IF_DEBUG("amount.convert") {
         char * tbuf = mpq_get_str(NULL, 10, quant);
         DEBUG("amount.convert", "Rational to convert = " << tbuf);
-        std::free(tbuf);
+        gmp_free_str(tbuf);
       }
 #endif
 
@@ -227,8 +512,17 @@ namespace {
 void amount_t::initialize()
 {
   if (! is_initialized) {
+    // GMP must allocate from the pool before it allocates anything at
+    // all, since blocks are returned to whichever allocator is current.
+    // The pool stays in place for the life of the process.
+    if (! gmp_uses_pool) {
+      mp_set_memory_functions(gmp_allocate, gmp_reallocate, gmp_deallocate);
+      gmp_uses_pool = true;
+    }
+
     mpz_init(temp);
     mpq_init(tempq);
+    mpq_init(tempqv);
     mpfr_init(tempf);
     mpfr_init(tempfb);
     mpfr_init(tempfnum);
@@ -262,6 +556,7 @@ void amount_t::shutdown()
   if (is_initialized) {
     mpz_clear(temp);
     mpq_clear(tempq);
+    mpq_clear(tempqv);
     mpfr_clear(tempf);
     mpfr_clear(tempfb);
     mpfr_clear(tempfnum);
@@ -269,6 +564,8 @@ void amount_t::shutdown()
 
     commodity_pool_t::current_pool.reset();
 
+    quantity_pool.release();
+
     is_initialized = false;
   }
 }
@@ -351,14 +648,17 @@ amount_t::amount_t(const double val) : commodity_(NULL)
 amount_t::amount_t(const unsigned long val) : commodity_(NULL)
 {
   quantity = new bigint_t;
-  mpq_set_ui(MP(quantity), val, 1);
+  if (val <= static_cast<unsigned long>(INT64_MAX))
+    quantity->set_small(static_cast<int64_t>(val), 0);
+  else
+    mpq_set_ui(MP(quantity), val, 1);
   TRACE_CTOR(amount_t, "const unsigned long");
 }
 
 amount_t::amount_t(const long val) : commodity_(NULL)
 {
   quantity = new bigint_t;
-  mpq_set_si(MP(quantity), val, 1);
+  quantity->set_small(val, 0);
   TRACE_CTOR(amount_t, "const long");
 }
 
@@ -394,6 +694,10 @@ int amount_t::compare(const amount_t& amt) const
            % commodity() % amt.commodity());
   }
 
+  int result;
+  if (quantity->small_compare(*amt.quantity, result))
+    return result;
+
   return mpq_cmp(MP(quantity), MP(amt.quantity));
 }
 
@@ -406,6 +710,10 @@ bool amount_t::operator==(const amount_t& amt) const
   else if (commodity() != amt.commodity())
     return false;
 
+  int result;
+  if (quantity->small_compare(*amt.quantity, result))
+    return result == 0;
+
   return mpq_equal(MP(quantity), MP(amt.quantity));
 }
 
@@ -431,7 +739,8 @@ amount_t& amount_t::operator+=(const amount_t& amt)
 
   _dup();
 
-  mpq_add(MP(quantity), MP(quantity), MP(amt.quantity));
+  if (! quantity->small_add(*amt.quantity, false))
+    mpq_add(MP(quantity), MP(quantity), MP(amt.quantity));
 
   if (has_commodity() == amt.has_commodity())
     if (quantity->prec < amt.quantity->prec)
@@ -461,7 +770,8 @@ amount_t& amount_t::operator-=(const amount_t& amt)
 
   _dup();
 
-  mpq_sub(MP(quantity), MP(quantity), MP(amt.quantity));
+  if (! quantity->small_add(*amt.quantity, true))
+    mpq_sub(MP(quantity), MP(quantity), MP(amt.quantity));
 
   if (has_commodity() == amt.has_commodity())
     if (quantity->prec < amt.quantity->prec)
@@ -485,7 +795,8 @@ amount_t& amount_t::multiply(const amount_t& amt, bool ignore_commodity)
 
   _dup();
 
-  mpq_mul(MP(quantity), MP(quantity), MP(amt.quantity));
+  if (! quantity->small_multiply(*amt.quantity))
+    mpq_mul(MP(quantity), MP(quantity), MP(amt.quantity));
   quantity->prec =
     static_cast<precision_t>(quantity->prec + amt.quantity->prec);
 
@@ -592,7 +903,10 @@ void amount_t::in_place_negate()
 {
   if (quantity) {
     _dup();
-    mpq_neg(MP(quantity), MP(quantity));
+    if (quantity->small && quantity->mant != INT64_MIN)
+      quantity->mant = - quantity->mant;
+    else
+      mpq_neg(MP(quantity), MP(quantity));
   } else {
     throw_(amount_error, _("Cannot negate an uninitialized amount"));
   }
@@ -822,6 +1136,9 @@ int amount_t::sign() const
   if (! quantity)
     throw_(amount_error, _("Cannot determine sign of an uninitialized amount"));
 
+  if (quantity->small)
+    return quantity->mant < 0 ? -1 : (quantity->mant > 0 ? 1 : 0);
+
   return mpq_sgn(MP(quantity));
 }
 
@@ -837,8 +1154,8 @@ bool amount_t::is_zero() const
     else if (is_realzero()) {
       return true;
     }
-    else if (mpz_cmp(mpq_numref(MP(quantity)),
-                     mpq_denref(MP(quantity))) > 0) {
+    else if (mpz_cmp(mpq_numref(quantity->view(tempqv)),
+                     mpq_denref(quantity->view(tempqv))) > 0) {
       DEBUG("amount.is_zero", "Numerator is larger than the denominator");
       return false;
     }
@@ -846,7 +1163,7 @@ bool amount_t::is_zero() const
       DEBUG("amount.is_zero", "We have to print the number to check for zero");
 
       std::ostringstream out;
-      stream_out_mpq(out, MP(quantity), commodity().precision());
+      stream_out_mpq(out, quantity->view(tempqv), commodity().precision());
 
       string output = out.str();
       if (! output.empty()) {
@@ -866,7 +1183,7 @@ double amount_t::to_double() const
   if (! quantity)
     throw_(amount_error, _("Cannot convert an uninitialized amount to a double"));
 
-  mpfr_set_q(tempf, MP(quantity), GMP_RNDN);
+  mpfr_set_q(tempf, quantity->view(tempqv), GMP_RNDN);
   return mpfr_get_d(tempf, GMP_RNDN);
 }
 
@@ -875,13 +1192,17 @@ long amount_t::to_long() const
   if (! quantity)
     throw_(amount_error, _("Cannot convert an uninitialized amount to a long"));
 
-  mpfr_set_q(tempf, MP(quantity), GMP_RNDN);
+  if (quantity->small && quantity->scale == 0 &&
+      quantity->mant >= LONG_MIN && quantity->mant <= LONG_MAX)
+    return static_cast<long>(quantity->mant);
+
+  mpfr_set_q(tempf, quantity->view(tempqv), GMP_RNDN);
   return mpfr_get_si(tempf, GMP_RNDN);
 }
 
 bool amount_t::fits_in_long() const
 {
-  mpfr_set_q(tempf, MP(quantity), GMP_RNDN);
+  mpfr_set_q(tempf, quantity->view(tempqv), GMP_RNDN);
   return mpfr_fits_slong_p(tempf, GMP_RNDN);
 }
 
@@ -1180,37 +1501,64 @@ bool amount_t::parse(std::istream& in, const parse_flags_t& flags)
       commodity().set_precision(new_quantity->prec);
   }
 
-  // Now we have the final number.  Remove commas and periods, if necessary.
-
-  if (last_comma != string::npos || last_period != string::npos) {
-    string::size_type  len = quant.length();
-    scoped_array<char> buf(new char[len + 1]);
-    const char *       p   = quant.c_str();
-    char *             t   = buf.get();
-
-    while (*p) {
-      if (*p == ',' || *p == '.')
-        p++;
-      *t++ = *p++;
+  // Now we have the final number.  Most quantities have few enough digits
+  // to be held in 64 bits; the rest are read by GMP, after removing commas
+  // and periods.
+
+  bool parsed = false;
+  if (new_quantity->prec <= BIGINT_MAX_SCALE) {
+    int64_t     mant   = 0;
+    std::size_t digits = 0;
+    bool        plain  = true;
+    foreach (const char& ch, quant) {
+      if (std::isdigit(ch)) {
+        if (++digits > BIGINT_MAX_SCALE)
+          break;
+        mant = mant * 10 + (ch - '0');
+      }
+      else if (ch != ',' && ch != '.') {
+        plain = false;
+        break;
+      }
+    }
+    if (plain && digits > 0 && digits <= BIGINT_MAX_SCALE) {
+      new_quantity->set_small(negative ? - mant : mant,
+                              static_cast<uint8_t>(new_quantity->prec));
+      parsed = true;
     }
-    *t = '\0';
+  }
+
+  if (! parsed) {
+    if (last_comma != string::npos || last_period != string::npos) {
+      string::size_type  len = quant.length();
+      scoped_array<char> buf(new char[len + 1]);
+      const char *       p   = quant.c_str();
+      char *             t   = buf.get();
+
+      while (*p) {
+        if (*p == ',' || *p == '.')
+          p++;
+        *t++ = *p++;
+      }
+      *t = '\0';
 
-    mpq_set_str(MP(new_quantity.get()), buf.get(), 10);
-    mpz_ui_pow_ui(temp, 10, new_quantity->prec);
-    mpq_set_z(tempq, temp);
-    mpq_div(MP(new_quantity.get()), MP(new_quantity.get()), tempq);
+      mpq_set_str(MP(new_quantity.get()), buf.get(), 10);
+      mpz_ui_pow_ui(temp, 10, new_quantity->prec);
+      mpq_set_z(tempq, temp);
+      mpq_div(MP(new_quantity.get()), MP(new_quantity.get()), tempq);
 
-    IF_DEBUG("amount.parse") {
-      char * amt_buf = mpq_get_str(NULL, 10, MP(new_quantity.get()));
-      DEBUG("amount.parse", "Rational parsed = " << amt_buf);
-      std::free(amt_buf);
+      IF_DEBUG("amount.parse") {
+        char * amt_buf = mpq_get_str(NULL, 10, MP(new_quantity.get()));
+        DEBUG("amount.parse", "Rational parsed = " << amt_buf);
+        gmp_free_str(amt_buf);
+      }
+    } else {
+      mpq_set_str(MP(new_quantity.get()), quant.c_str(), 10);
     }
-  } else {
-    mpq_set_str(MP(new_quantity.get()), quant.c_str(), 10);
-  }
 
-  if (negative)
-    mpq_neg(MP(new_quantity.get()), MP(new_quantity.get()));
+    if (negative)
+      mpq_neg(MP(new_quantity.get()), MP(new_quantity.get()));
+  }
 
   new_quantity->refc++;
   quantity = new_quantity.release();
@@ -1269,7 +1617,7 @@ void amount_t::print(std::ostream& _out, const uint_least8_t flags) const
       out << " ";
   }
 
-  stream_out_mpq(out, MP(quantity), display_precision(),
+  stream_out_mpq(out, quantity->view(tempqv), display_precision(),
                  comm ? commodity().precision() : 0, GMP_RNDN, comm);
 
   if (comm.has_flags(COMMODITY_STYLE_SUFFIXED)) {
@@ -1288,6 +1636,89 @@ void amount_t::print(std::ostream& _out, const uint_least8_t flags) const
   _out << out.str();
 }
 
+namespace {
+  void write_mpz(std::ostream& out, mpz_t z)
+  {
+    std::size_t count = (mpz_sizeinbase(z, 2) + 7) / 8;
+    std::vector<char> buf(count);
+    mpz_export(buf.data(), &count, 1, 1, 1, 0, z);
+
+    uint32_t len = static_cast<uint32_t>(count);
+    out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+    out.write(buf.data(), static_cast<std::streamsize>(count));
+  }
+
+  void read_mpz(const char *& data, const char * end, mpz_t z)
+  {
+    uint32_t len;
+    if (end - data < static_cast<std::ptrdiff_t>(sizeof(len)))
+      throw_(amount_error, _("Truncated amount quantity"));
+    std::memcpy(&len, data, sizeof(len));
+    data += sizeof(len);
+
+    if (end - data < static_cast<std::ptrdiff_t>(len))
+      throw_(amount_error, _("Truncated amount quantity"));
+    mpz_import(z, len, 1, 1, 1, 0, data);
+    data += len;
+  }
+}
+
+void amount_t::write_quantity(std::ostream& out) const
+{
+  if (! quantity) {
+    out.put(0);
+    return;
+  }
+
+  mpq_ptr q = quantity->view(tempqv);
+
+  char flags = 0x01;
+  if (quantity->has_flags(BIGINT_KEEP_PREC))
+    flags |= 0x02;
+  if (mpq_sgn(q) < 0)
+    flags |= 0x04;
+  out.put(flags);
+
+  out.write(reinterpret_cast<const char *>(&quantity->prec),
+            sizeof(quantity->prec));
+
+  write_mpz(out, mpq_numref(q));
+  write_mpz(out, mpq_denref(q));
+}
+
+void amount_t::read_quantity(const char *& data, const char * end)
+{
+  if (quantity)
+    _release();
+  commodity_ = NULL;
+
+  if (data == end)
+    throw_(amount_error, _("Truncated amount quantity"));
+  char flags = *data++;
+  if (! flags)
+    return;
+
+  unique_ptr<bigint_t> new_quantity(new bigint_t);
+
+  if (end - data < static_cast<std::ptrdiff_t>(sizeof(new_quantity->prec)))
+    throw_(amount_error, _("Truncated amount quantity"));
+  std::memcpy(&new_quantity->prec, data, sizeof(new_quantity->prec));
+  data += sizeof(new_quantity->prec);
+
+  read_mpz(data, end, mpq_numref(MP(new_quantity.get())));
+  read_mpz(data, end, mpq_denref(MP(new_quantity.get())));
+  if (flags & 0x04)
+    mpz_neg(mpq_numref(MP(new_quantity.get())),
+            mpq_numref(MP(new_quantity.get())));
+
+  if (flags & 0x02)
+    new_quantity->add_flags(BIGINT_KEEP_PREC);
+
+  quantity = new_quantity.release();
+
+  VERIFY(valid());
+}
+
 bool amount_t::valid() const
 {
   if (quantity) {
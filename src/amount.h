@@ -720,6 +720,28 @@ public:
 
   /*@}*/
 
+  /** @name Serialization
+   */
+  /*@{*/
+
+  /** The quantity of an amount, without its commodity, may be written to
+      and read back from a compact binary form, as used by the journal
+      cache (see cache.h).
+
+      write_quantity(ostream) writes the exact rational value, its
+      internal precision and whether precision is being kept.  A null
+      amount is written as a single zero byte.
+
+      read_quantity(data, end) reads a quantity written by
+      write_quantity, advancing `data' past it.  An amount_error is
+      thrown if the buffer ends before the quantity does.  The commodity
+      of the amount is left unset.
+  */
+  void write_quantity(std::ostream& out) const;
+  void read_quantity(const char *& data, const char * end);
+
+  /*@}*/
+
   /** @name Debugging
    */
   /*@{*/
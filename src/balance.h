@@ -50,6 +50,7 @@
 #define _BALANCE_H
 
 #include "amount.h"
+#include "flatmap.h"
 
 namespace ledger {
 
@@ -80,7 +81,8 @@ class balance_t
            multiplicative<balance_t, long> > > > > > > > > > > > > >
 {
 public:
-  typedef std::map<commodity_t *, amount_t> amounts_map;
+  // Most balances hold only a few commodities, which are kept inline.
+  typedef flat_map_t<commodity_t *, amount_t, 3> amounts_map;
 
   amounts_map amounts;
 
@@ -0,0 +1,863 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <system.hh>
+
+#include "cache.h"
+#include "journal.h"
+#include "xact.h"
+#include "post.h"
+#include "account.h"
+#include "pool.h"
+
+namespace ledger {
+
+namespace {
+  const char     cache_magic[]   = "LEDGERC";
+  const char     cache_trailer[] = "LEDGEND";
+  const uint32_t cache_version   = 1;
+
+  typedef tuple<const commodity_t *, datetime_t, amount_t> price_entry_t;
+
+  string file_digest(const path& pathname)
+  {
+    ifstream in(pathname, std::ios::in | std::ios::binary);
+    string contents((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+    return sha1sum(contents);
+  }
+
+  std::size_t count_accounts(const account_t& account)
+  {
+    std::size_t count = 1;
+    foreach (const accounts_map::value_type& pair, account.accounts)
+      count += count_accounts(*pair.second);
+    return count;
+  }
+
+  class cache_writer_t
+  {
+    std::ostream& out;
+
+    std::map<const commodity_t *, uint32_t> commodity_ids;
+    std::map<const account_t *, uint32_t>   account_ids;
+    std::map<string, uint32_t>              path_ids;
+
+  public:
+    explicit cache_writer_t(std::ostream& _out) : out(_out) {}
+
+    template <typename T>
+    void write_number(const T num) {
+      out.write(reinterpret_cast<const char *>(&num), sizeof(num));
+    }
+    void write_bool(const bool val) {
+      out.put(val ? 1 : 0);
+    }
+    void write_string(const string& str) {
+      write_number(static_cast<uint32_t>(str.length()));
+      out.write(str.c_str(), static_cast<std::streamsize>(str.length()));
+    }
+    void write_optional_string(const optional<string>& str) {
+      write_bool(static_cast<bool>(str));
+      if (str)
+        write_string(*str);
+    }
+
+    void write_date(const date_t& when) {
+      if (when.is_special())
+        throw_(cache_error, _("Cannot cache a special date value"));
+      write_number(static_cast<uint32_t>(when.day_number()));
+    }
+    void write_optional_date(const optional<date_t>& when) {
+      write_bool(static_cast<bool>(when));
+      if (when)
+        write_date(*when);
+    }
+    void write_datetime(const datetime_t& when) {
+      if (when.is_special())
+        throw_(cache_error, _("Cannot cache a special date value"));
+      write_date(when.date());
+      write_number(static_cast<int64_t>(when.time_of_day().ticks()));
+    }
+    void write_optional_datetime(const optional<datetime_t>& when) {
+      write_bool(static_cast<bool>(when));
+      if (when)
+        write_datetime(*when);
+    }
+
+    void write_commodity(const commodity_t& comm) {
+      std::map<const commodity_t *, uint32_t>::const_iterator i =
+        commodity_ids.find(&comm);
+      if (i == commodity_ids.end())
+        throw_(cache_error,
+               _f("Cannot cache a reference to commodity %1%") % comm);
+      write_number((*i).second);
+    }
+    void write_amount(const amount_t& amt) {
+      amt.write_quantity(out);
+      if (! amt.is_null()) {
+        write_bool(amt.has_commodity());
+        if (amt.has_commodity())
+          write_commodity(amt.commodity());
+      }
+    }
+    void write_optional_amount(const optional<amount_t>& amt) {
+      write_bool(static_cast<bool>(amt));
+      if (amt)
+        write_amount(*amt);
+    }
+
+    void write_account(const account_t * account) {
+      std::map<const account_t *, uint32_t>::const_iterator i =
+        account_ids.find(account);
+      if (i == account_ids.end())
+        throw_(cache_error, _("Cannot cache a reference to a foreign account"));
+      write_number((*i).second);
+    }
+    void write_mask(const mask_t& mask) {
+      write_string(mask.str());
+    }
+
+    void write_value(const value_t& val) {
+      write_number(static_cast<uint8_t>(val.type()));
+      switch (val.type()) {
+      case value_t::VOID:
+        break;
+      case value_t::BOOLEAN:
+        write_bool(val.as_boolean());
+        break;
+      case value_t::DATETIME:
+        write_datetime(val.as_datetime());
+        break;
+      case value_t::DATE:
+        write_date(val.as_date());
+        break;
+      case value_t::INTEGER:
+        write_number(static_cast<int64_t>(val.as_long()));
+        break;
+      case value_t::AMOUNT:
+        write_amount(val.as_amount());
+        break;
+      case value_t::STRING:
+        write_string(val.as_string());
+        break;
+      default:
+        throw_(cache_error, _f("Cannot cache %1%") % val.label());
+      }
+    }
+
+    void write_position(const position_t& pos) {
+      const string pathname(pos.pathname.string());
+      std::map<string, uint32_t>::const_iterator i = path_ids.find(pathname);
+      if (i == path_ids.end()) {
+        // Each path is written out in full the first time it is used.
+        uint32_t id = static_cast<uint32_t>(path_ids.size());
+        path_ids.insert(std::map<string, uint32_t>::value_type(pathname, id));
+        write_number(id);
+        write_string(pathname);
+      } else {
+        write_number((*i).second);
+      }
+      write_number(static_cast<int64_t>(std::streamoff(pos.beg_pos)));
+      write_number(static_cast<uint64_t>(pos.beg_line));
+      write_number(static_cast<int64_t>(std::streamoff(pos.end_pos)));
+      write_number(static_cast<uint64_t>(pos.end_line));
+      write_number(static_cast<uint64_t>(pos.sequence));
+    }
+
+    void write_item(const item_t& item) {
+      write_number(static_cast<uint16_t>(item.flags()));
+      write_number(static_cast<uint8_t>(item._state));
+      write_optional_date(item._date);
+      write_optional_date(item._date_aux);
+      write_optional_string(item.note);
+
+      write_bool(static_cast<bool>(item.pos));
+      if (item.pos)
+        write_position(*item.pos);
+
+      write_bool(static_cast<bool>(item.metadata));
+      if (item.metadata) {
+        write_number(static_cast<uint32_t>(item.metadata->size()));
+        foreach (const item_t::string_map::value_type& pair, *item.metadata) {
+          write_string(pair.first);
+          write_bool(static_cast<bool>(pair.second.first));
+          if (pair.second.first)
+            write_value(*pair.second.first);
+          write_bool(pair.second.second);
+        }
+      }
+    }
+
+    void write_header(const string& key) {
+      out.write(cache_magic, sizeof(cache_magic));
+      write_number(cache_version);
+      write_string(key);
+    }
+
+    void write_sources(const journal_t& journal) {
+      write_number(static_cast<uint32_t>(journal.sources.size()));
+      foreach (const journal_t::fileinfo_t& info, journal.sources) {
+        if (info.from_stream)
+          throw_(cache_error, _("Cannot cache a journal read from a stream"));
+
+        const path&  pathname(*info.filename);
+        std::time_t  modtime = last_write_time(pathname);
+        uintmax_t    size    = file_size(pathname);
+
+        // If a file changed after it was parsed, its digest would not
+        // describe what is in the journal.
+        if (size != info.size || posix_time::from_time_t(modtime) != info.modtime)
+          throw_(cache_error,
+                 _f("File %1% changed while it was being read") % pathname);
+
+        write_string(pathname.string());
+        write_number(static_cast<uint64_t>(size));
+        write_number(static_cast<int64_t>(modtime));
+        write_string(file_digest(pathname));
+      }
+    }
+
+    void write_commodities(const commodity_pool_t& pool) {
+      // Base commodities are written in the order they were added to the
+      // price graph, so that reloading them assigns the same indices.
+      std::vector<const commodity_t *> bases;
+      foreach (const commodity_pool_t::commodities_map::value_type& pair,
+               pool.commodities)
+        if (pair.first == pair.second->base_symbol())
+          bases.push_back(pair.second.get());
+      std::sort(bases.begin(), bases.end(),
+                [](const commodity_t * left, const commodity_t * right) {
+                  return left->graph_index() < right->graph_index();
+                });
+
+      write_number(static_cast<uint32_t>(bases.size()));
+      foreach (const commodity_t * comm, bases) {
+        if (comm->value_expr())
+          throw_(cache_error,
+                 _f("Cannot cache the valuation expression of %1%") % *comm);
+        uint32_t id = static_cast<uint32_t>(commodity_ids.size());
+        commodity_ids.insert(std::make_pair(comm, id));
+        write_string(comm->base_symbol());
+      }
+
+      write_number(static_cast<uint32_t>(pool.annotated_commodities.size()));
+      foreach (const commodity_pool_t::annotated_commodities_map::value_type&
+               pair, pool.annotated_commodities) {
+        const annotated_commodity_t& comm(*pair.second);
+        if (comm.details.value_expr)
+          throw_(cache_error,
+                 _f("Cannot cache the valuation expression of %1%") % comm);
+
+        write_commodity(comm.referent());
+        write_number(static_cast<uint8_t>(comm.details.flags()));
+        write_optional_amount(comm.details.price);
+        write_optional_date(comm.details.date);
+        write_optional_string(comm.details.tag);
+
+        uint32_t id = static_cast<uint32_t>(commodity_ids.size());
+        commodity_ids.insert(std::make_pair(&comm, id));
+      }
+
+      // The details of base commodities are written last, since parsing
+      // annotated amounts also changes the flags of their base.
+      foreach (const commodity_t * comm, bases) {
+        write_number(static_cast<uint16_t>(comm->flags()));
+        write_number(static_cast<uint16_t>(comm->precision()));
+        write_optional_string(comm->name());
+        write_optional_string(comm->note());
+      }
+
+      uint32_t aliases = 0;
+      foreach (const commodity_pool_t::commodities_map::value_type& pair,
+               pool.commodities)
+        if (pair.first != pair.second->base_symbol())
+          ++aliases;
+      write_number(aliases);
+      foreach (const commodity_pool_t::commodities_map::value_type& pair,
+               pool.commodities) {
+        if (pair.first != pair.second->base_symbol()) {
+          write_string(pair.first);
+          write_commodity(*pair.second);
+        }
+      }
+
+      write_bool(pool.default_commodity != NULL);
+      if (pool.default_commodity)
+        write_commodity(*pool.default_commodity);
+    }
+
+    void write_accounts(const account_t& account, uint32_t parent) {
+      if (account.value_expr)
+        throw_(cache_error,
+               _f("Cannot cache the valuation expression of account %1%")
+               % account.fullname());
+      if (account.deferred_posts && ! account.deferred_posts->empty())
+        throw_(cache_error,
+               _f("Cannot cache the deferred postings of account %1%")
+               % account.fullname());
+
+      uint32_t id = static_cast<uint32_t>(account_ids.size());
+      account_ids.insert(std::make_pair(&account, id));
+
+      write_number(parent);
+      write_string(account.name);
+      write_number(static_cast<uint8_t>(account.flags()));
+      write_optional_string(account.note);
+
+      foreach (const accounts_map::value_type& pair, account.accounts)
+        write_accounts(*pair.second, id);
+    }
+
+    void write_prices(commodity_pool_t& pool) {
+      std::vector<price_entry_t> prices;
+      pool.commodity_price_history.map_price_points
+        ([&](const commodity_t& source, const datetime_t& when,
+             const amount_t& price) {
+          prices.push_back(price_entry_t(&source, when, price));
+        });
+
+      write_number(static_cast<uint32_t>(prices.size()));
+      foreach (const price_entry_t& entry, prices) {
+        write_commodity(*entry.get<0>());
+        write_datetime(entry.get<1>());
+        write_amount(entry.get<2>());
+      }
+    }
+
+    void check_account_posts(const journal_t& journal) {
+      // The postings of each account are rebuilt from the transactions
+      // when the cache is read, so they must be in the same order.
+      std::map<const account_t *, posts_list::const_iterator> cursors;
+      foreach (const xact_t * xact, journal.xacts) {
+        foreach (const post_t * post, xact->posts) {
+          if (post->amount_expr || post->has_flags(POST_DEFERRED))
+            throw_(cache_error, _("Cannot cache a posting expression"));
+
+          std::map<const account_t *, posts_list::const_iterator>::iterator
+            i = cursors.find(post->account);
+          if (i == cursors.end())
+            i = cursors.insert(std::make_pair(post->account,
+                                              post->account->posts.begin()))
+              .first;
+          if ((*i).second == post->account->posts.end() ||
+              *(*i).second != post)
+            throw_(cache_error,
+                   _f("Postings of account %1% are out of order")
+                   % post->account->fullname());
+          ++(*i).second;
+        }
+      }
+
+      typedef std::map<const account_t *, posts_list::const_iterator>::value_type
+        cursor_t;
+      foreach (const cursor_t& cursor, cursors)
+        if (cursor.second != cursor.first->posts.end())
+          throw_(cache_error,
+                 _f("Account %1% has postings outside the journal")
+                 % cursor.first->fullname());
+    }
+
+    void write_xacts(const journal_t& journal) {
+      write_number(static_cast<uint32_t>(journal.xacts.size()));
+      foreach (const xact_t * xact, journal.xacts) {
+        write_item(*xact);
+        write_optional_string(xact->code);
+        write_string(xact->payee);
+
+        write_number(static_cast<uint32_t>(xact->posts.size()));
+        foreach (const post_t * post, xact->posts) {
+          write_item(*post);
+          write_account(post->account);
+          write_amount(post->amount);
+          write_optional_amount(post->cost);
+          write_optional_amount(post->given_cost);
+          write_optional_amount(post->assigned_amount);
+          write_optional_datetime(post->checkin);
+          write_optional_datetime(post->checkout);
+        }
+      }
+    }
+
+    void write_journal(journal_t& journal) {
+      commodity_pool_t& pool(*commodity_pool_t::current_pool);
+
+      write_commodities(pool);
+
+      write_number(static_cast<uint32_t>(count_accounts(*journal.master)));
+      write_accounts(*journal.master, 0);
+
+      write_bool(journal.bucket != NULL);
+      if (journal.bucket)
+        write_account(journal.bucket);
+
+      write_number(static_cast<uint32_t>(journal.account_aliases.size()));
+      foreach (const accounts_map::value_type& pair, journal.account_aliases) {
+        write_string(pair.first);
+        write_account(pair.second);
+      }
+      write_number(static_cast<uint32_t>(journal.account_mappings.size()));
+      foreach (const account_mapping_t& pair, journal.account_mappings) {
+        write_mask(pair.first);
+        write_account(pair.second);
+      }
+      write_number(static_cast<uint32_t>
+                   (journal.payees_for_unknown_accounts.size()));
+      foreach (const account_mapping_t& pair,
+               journal.payees_for_unknown_accounts) {
+        write_mask(pair.first);
+        write_account(pair.second);
+      }
+      write_number(static_cast<uint32_t>(journal.payee_alias_mappings.size()));
+      foreach (const payee_alias_mapping_t& pair,
+               journal.payee_alias_mappings) {
+        write_mask(pair.first);
+        write_string(pair.second);
+      }
+      write_number(static_cast<uint32_t>(journal.payee_uuid_mappings.size()));
+      foreach (const payee_uuid_mapping_t& pair, journal.payee_uuid_mappings) {
+        write_string(pair.first);
+        write_string(pair.second);
+      }
+      write_number(static_cast<uint32_t>(journal.known_payees.size()));
+      foreach (const string& payee, journal.known_payees)
+        write_string(payee);
+      write_number(static_cast<uint32_t>(journal.known_tags.size()));
+      foreach (const string& tag, journal.known_tags)
+        write_string(tag);
+
+      write_prices(pool);
+
+      check_account_posts(journal);
+      write_xacts(journal);
+
+      out.write(cache_trailer, sizeof(cache_trailer));
+    }
+  };
+
+  class cache_reader_t
+  {
+    const char * data;
+    const char * end;
+
+    std::vector<commodity_t *> commodities;
+    std::vector<account_t *>   accounts;
+    std::vector<path>          paths;
+
+  public:
+    cache_reader_t(const char * _data, const char * _end)
+      : data(_data), end(_end) {}
+
+    void need(const std::size_t len) {
+      if (static_cast<std::size_t>(end - data) < len)
+        throw_(cache_error, _("Journal cache ends unexpectedly"));
+    }
+
+    template <typename T>
+    T read_number() {
+      T num;
+      need(sizeof(num));
+      std::memcpy(&num, data, sizeof(num));
+      data += sizeof(num);
+      return num;
+    }
+    bool read_bool() {
+      return read_number<uint8_t>() != 0;
+    }
+    string read_string() {
+      uint32_t len = read_number<uint32_t>();
+      need(len);
+      string str(data, len);
+      data += len;
+      return str;
+    }
+    optional<string> read_optional_string() {
+      if (read_bool())
+        return read_string();
+      return none;
+    }
+
+    date_t read_date() {
+      return date_t(gregorian::gregorian_calendar::from_day_number
+                    (read_number<uint32_t>()));
+    }
+    optional<date_t> read_optional_date() {
+      if (read_bool())
+        return read_date();
+      return none;
+    }
+    datetime_t read_datetime() {
+      date_t when(read_date());
+      return datetime_t(when, posix_time::time_duration
+                        (0, 0, 0, read_number<int64_t>()));
+    }
+    optional<datetime_t> read_optional_datetime() {
+      if (read_bool())
+        return read_datetime();
+      return none;
+    }
+
+    commodity_t& read_commodity() {
+      uint32_t id = read_number<uint32_t>();
+      if (id >= commodities.size())
+        throw_(cache_error, _("Journal cache refers to an unknown commodity"));
+      return *commodities[id];
+    }
+    amount_t read_amount() {
+      amount_t amt;
+      amt.read_quantity(data, end);
+      if (! amt.is_null() && read_bool())
+        amt.set_commodity(read_commodity());
+      return amt;
+    }
+    optional<amount_t> read_optional_amount() {
+      if (read_bool())
+        return read_amount();
+      return none;
+    }
+
+    account_t * read_account() {
+      uint32_t id = read_number<uint32_t>();
+      if (id >= accounts.size())
+        throw_(cache_error, _("Journal cache refers to an unknown account"));
+      return accounts[id];
+    }
+
+    value_t read_value() {
+      switch (static_cast<value_t::type_t>(read_number<uint8_t>())) {
+      case value_t::VOID:
+        return NULL_VALUE;
+      case value_t::BOOLEAN:
+        return read_bool();
+      case value_t::DATETIME:
+        return read_datetime();
+      case value_t::DATE:
+        return read_date();
+      case value_t::INTEGER:
+        return static_cast<long>(read_number<int64_t>());
+      case value_t::AMOUNT:
+        return read_amount();
+      case value_t::STRING:
+        return string_value(read_string());
+      default:
+        throw_(cache_error, _("Journal cache contains an unknown value type"));
+      }
+      return NULL_VALUE;
+    }
+
+    position_t read_position() {
+      position_t pos;
+      uint32_t id = read_number<uint32_t>();
+      if (id == paths.size())
+        paths.push_back(read_string());
+      else if (id > paths.size())
+        throw_(cache_error, _("Journal cache refers to an unknown file"));
+      pos.pathname = paths[id];
+      pos.beg_pos  = std::streamoff(read_number<int64_t>());
+      pos.beg_line = static_cast<std::size_t>(read_number<uint64_t>());
+      pos.end_pos  = std::streamoff(read_number<int64_t>());
+      pos.end_line = static_cast<std::size_t>(read_number<uint64_t>());
+      pos.sequence = static_cast<std::size_t>(read_number<uint64_t>());
+      return pos;
+    }
+
+    void read_item(item_t& item) {
+      item.set_flags(read_number<uint16_t>());
+      item.set_state(static_cast<item_t::state_t>(read_number<uint8_t>()));
+      item._date     = read_optional_date();
+      item._date_aux = read_optional_date();
+      item.note      = read_optional_string();
+
+      if (read_bool())
+        item.pos = read_position();
+
+      if (read_bool()) {
+        for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+          string tag(read_string());
+          optional<value_t> value;
+          if (read_bool())
+            value = read_value();
+          item_t::string_map::iterator i = item.set_tag(tag, value);
+          (*i).second.second = read_bool();
+        }
+      }
+    }
+
+    bool read_header(const string& key) {
+      need(sizeof(cache_magic));
+      if (std::memcmp(data, cache_magic, sizeof(cache_magic)) != 0)
+        return false;
+      data += sizeof(cache_magic);
+
+      if (read_number<uint32_t>() != cache_version) {
+        DEBUG("cache.load", "Journal cache was written by another version");
+        return false;
+      }
+      if (read_string() != key) {
+        DEBUG("cache.load", "Journal cache was written with other options");
+        return false;
+      }
+      return true;
+    }
+
+    bool read_sources(std::list<path>& sources) {
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        path     pathname(read_string());
+        uint64_t size    = read_number<uint64_t>();
+        int64_t  modtime = read_number<int64_t>();
+        string   digest(read_string());
+
+        if (! exists(pathname) || file_size(pathname) != size) {
+          DEBUG("cache.load", "Source file " << pathname << " has changed");
+          return false;
+        }
+        // A file that was only touched still matches by its contents.
+        if (last_write_time(pathname) != modtime &&
+            file_digest(pathname) != digest) {
+          DEBUG("cache.load", "Source file " << pathname << " has changed");
+          return false;
+        }
+        sources.push_back(pathname);
+      }
+      return true;
+    }
+
+    void read_commodities(commodity_pool_t& pool) {
+      uint32_t bases = read_number<uint32_t>();
+      for (uint32_t i = 0; i < bases; i++)
+        commodities.push_back(pool.find_or_create(read_string()));
+
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        commodity_t& comm(read_commodity());
+        annotation_t details;
+        details.set_flags(read_number<uint8_t>());
+        details.price = read_optional_amount();
+        details.date  = read_optional_date();
+        details.tag   = read_optional_string();
+        commodities.push_back(pool.find_or_create(comm, details));
+      }
+
+      for (uint32_t i = 0; i < bases; i++) {
+        commodity_t * comm = commodities[i];
+        comm->set_flags(read_number<uint16_t>());
+        comm->set_precision(read_number<uint16_t>());
+        comm->set_name(read_optional_string());
+        comm->set_note(read_optional_string());
+      }
+
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        string name(read_string());
+        pool.alias(name, read_commodity());
+      }
+
+      if (read_bool())
+        pool.default_commodity = &read_commodity();
+    }
+
+    void read_accounts(journal_t& journal) {
+      uint32_t count = read_number<uint32_t>();
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t    parent = read_number<uint32_t>();
+        string      name(read_string());
+        account_t * account;
+        if (i == 0) {
+          account = journal.master;
+        } else {
+          if (parent >= accounts.size())
+            throw_(cache_error,
+                   _("Journal cache refers to an unknown account"));
+          account = accounts[parent]->find_account(name);
+        }
+        account->set_flags(read_number<uint8_t>());
+        account->note = read_optional_string();
+        accounts.push_back(account);
+      }
+    }
+
+    void read_xacts(journal_t& journal) {
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        unique_ptr<xact_t> xact(new xact_t);
+        read_item(*xact);
+        xact->code  = read_optional_string();
+        xact->payee = read_string();
+
+        for (uint32_t posts = read_number<uint32_t>(); posts > 0; --posts) {
+          unique_ptr<post_t> post(new post_t);
+          read_item(*post);
+          post->account         = read_account();
+          post->amount          = read_amount();
+          post->cost            = read_optional_amount();
+          post->given_cost      = read_optional_amount();
+          post->assigned_amount = read_optional_amount();
+          post->checkin         = read_optional_datetime();
+          post->checkout        = read_optional_datetime();
+
+          xact->add_post(post.get());
+          post->account->add_post(post.release());
+        }
+
+        xact->journal = &journal;
+        if (optional<value_t> ref = xact->get_tag(_("UUID")))
+          journal.checksum_map.insert(ref->to_string(), xact.get());
+        journal.xacts.push_back(xact.release());
+      }
+    }
+
+    void read_journal(journal_t& journal) {
+      commodity_pool_t& pool(*commodity_pool_t::current_pool);
+
+      read_commodities(pool);
+      read_accounts(journal);
+
+      if (read_bool())
+        journal.bucket = read_account();
+
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        string name(read_string());
+        journal.account_aliases.insert
+          (accounts_map::value_type(name, read_account()));
+      }
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        mask_t mask(read_string());
+        journal.account_mappings.push_back
+          (account_mapping_t(mask, read_account()));
+      }
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        mask_t mask(read_string());
+        journal.payees_for_unknown_accounts.push_back
+          (account_mapping_t(mask, read_account()));
+      }
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        mask_t mask(read_string());
+        journal.payee_alias_mappings.push_back
+          (payee_alias_mapping_t(mask, read_string()));
+      }
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        string payee(read_string());
+        journal.payee_uuid_mappings.push_back
+          (payee_uuid_mapping_t(payee, read_string()));
+      }
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count)
+        journal.known_payees.insert(read_string());
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count)
+        journal.known_tags.insert(read_string());
+
+      for (uint32_t count = read_number<uint32_t>(); count > 0; --count) {
+        commodity_t& source(read_commodity());
+        datetime_t   when(read_datetime());
+        amount_t     price(read_amount());
+        pool.commodity_price_history.add_price(source, when, price);
+      }
+
+      read_xacts(journal);
+
+      need(sizeof(cache_trailer));
+      if (std::memcmp(data, cache_trailer, sizeof(cache_trailer)) != 0)
+        throw_(cache_error, _("Journal cache has trailing garbage"));
+    }
+  };
+}
+
+bool journal_cache_t::load(journal_t& journal)
+{
+  if (! exists(cache_file) ||
+      file_size(cache_file) < sizeof(cache_magic) + sizeof(cache_trailer))
+    return false;
+
+  boost::iostreams::mapped_file_source file(cache_file.string());
+
+  // A cache that was not completely written is simply ignored.
+  const char * end = file.data() + file.size();
+  if (std::memcmp(end - sizeof(cache_trailer), cache_trailer,
+                  sizeof(cache_trailer)) != 0) {
+    DEBUG("cache.load", "Journal cache is incomplete");
+    return false;
+  }
+
+  cache_reader_t reader(file.data(), end);
+  std::list<path> sources;
+  try {
+    if (! reader.read_header(key) || ! reader.read_sources(sources))
+      return false;
+
+    reader.read_journal(journal);
+  }
+  catch (const cache_error&) {
+    add_error_context(_f("While reading journal cache %1%:") % cache_file);
+    throw;
+  }
+
+  foreach (const path& pathname, sources)
+    journal.sources.push_back(journal_t::fileinfo_t(pathname));
+
+  DEBUG("cache.load", "Read " << journal.xacts.size()
+        << " transactions from journal cache " << cache_file);
+  return true;
+}
+
+bool journal_cache_t::save(journal_t& journal)
+{
+  if (! journal.cacheable || ! journal.auto_xacts.empty() ||
+      ! journal.period_xacts.empty() || ! journal.tag_check_exprs.empty() ||
+      journal.value_expr) {
+    DEBUG("cache.save", "Journal uses features which cannot be cached");
+    return false;
+  }
+
+  path temp_file(cache_file.string() + ".tmp");
+  try {
+    {
+      ofstream out(temp_file, std::ios::out | std::ios::binary |
+                   std::ios::trunc);
+      cache_writer_t writer(out);
+
+      writer.write_header(key);
+      writer.write_sources(journal);
+      writer.write_journal(journal);
+
+      if (! out.good())
+        throw_(cache_error, _f("Could not write %1%") % temp_file);
+    }
+    rename(temp_file, cache_file);
+  }
+  catch (const std::exception& err) {
+    DEBUG("cache.save", "Not caching journal: " << err.what());
+    boost::system::error_code ec;
+    remove(temp_file, ec);
+    return false;
+  }
+
+  DEBUG("cache.save", "Wrote " << journal.xacts.size()
+        << " transactions to journal cache " << cache_file);
+  return true;
+}
+
+} // namespace ledger
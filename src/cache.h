@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @addtogroup data
+ */
+
+/**
+ * @file   cache.h
+ * @author John Wiegley
+ *
+ * @ingroup data
+ *
+ * @brief  A binary cache of parsed journal data
+ */
+#ifndef _CACHE_H
+#define _CACHE_H
+
+#include "utils.h"
+
+namespace ledger {
+
+class journal_t;
+
+DECLARE_EXCEPTION(cache_error, std::runtime_error);
+
+/**
+ * @brief Saves a parsed journal to disk, and restores it on later runs.
+ *
+ * The cache records every source file that was read, by size,
+ * modification time and SHA1 digest, followed by the commodities,
+ * accounts, price history and transactions that parsing produced.  A
+ * cache is only used as a whole: if any of its sources have changed, or
+ * if the key (which describes the options that affect parsing) differs,
+ * load() declines and the caller parses the journal from text.
+ *
+ * Journals whose meaning depends on more than their text, such as those
+ * with automated transactions or value expressions that are evaluated
+ * while parsing, are never written to the cache.
+ */
+class journal_cache_t : public noncopyable
+{
+  path   cache_file;
+  string key;
+
+public:
+  journal_cache_t(const path& _cache_file, const string& _key)
+    : cache_file(_cache_file), key(_key) {
+    TRACE_CTOR(journal_cache_t, "const path&, const string&");
+  }
+  ~journal_cache_t() {
+    TRACE_DTOR(journal_cache_t);
+  }
+
+  /**
+   * Populate an empty journal from the cache file.  Returns false if
+   * there is no usable cache, in which case the journal is untouched.
+   */
+  bool load(journal_t& journal);
+
+  /**
+   * Write the journal to the cache file.  Returns false if the journal
+   * cannot be represented in the cache.
+   */
+  bool save(journal_t& journal);
+};
+
+} // namespace ledger
+
+#endif // _CACHE_H
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <system.hh>
+
+#include "checksum.h"
+
+namespace ledger {
+
+namespace {
+  const char        index_magic[] = "LEDGERU";
+  const uint32_t    index_version = 1;
+  const std::size_t header_size   = sizeof(index_magic) + sizeof(index_version);
+
+  inline int hex_value(const char c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    return -1;
+  }
+
+  // Only the lowercase form written by to_hex is decoded; any other
+  // spelling is a different UUID and must stay distinct.
+  bool parse_hex_digest(const string& uuid, boost::uint32_t digest[5])
+  {
+    if (uuid.length() != 40)
+      return false;
+
+    const char * p = uuid.c_str();
+    for (int i = 0; i < 5; i++) {
+      boost::uint32_t word = 0;
+      for (int j = 0; j < 8; j++) {
+        int value = hex_value(*p++);
+        if (value < 0)
+          return false;
+        word = (word << 4) | boost::uint32_t(value);
+      }
+      digest[i] = word;
+    }
+    return true;
+  }
+
+  std::size_t hash_key(const checksum_index_t::key_t& key)
+  {
+    boost::uint64_t h =
+      ((boost::uint64_t(key.digest[0]) << 32 | key.digest[1]) ^
+       (boost::uint64_t(key.digest[2]) << 32 | key.digest[3]) ^
+       (boost::uint64_t(key.digest[4]) << 32 | key.hashed));
+
+    // The MurmurHash3 finalizer, in case a UUID is not really a digest
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return static_cast<std::size_t>(h);
+  }
+
+  void write_keys(std::ostream& out,
+                  const std::vector<checksum_index_t::key_t>& keys)
+  {
+    if (! keys.empty())
+      out.write(reinterpret_cast<const char *>(&keys[0]),
+                static_cast<std::streamsize>
+                (keys.size() * sizeof(checksum_index_t::key_t)));
+  }
+}
+
+checksum_index_t::key_t checksum_index_t::make_key(const string& uuid)
+{
+  key_t key;
+
+  if (parse_hex_digest(uuid, key.digest)) {
+    key.hashed = 0;
+  } else {
+    boost::uuids::detail::sha1 sha;
+    sha.process_bytes(uuid.c_str(), uuid.length());
+
+    unsigned int message_digest[5];
+    sha.get_digest(message_digest);
+    for (int i = 0; i < 5; i++)
+      key.digest[i] = message_digest[i];
+    key.hashed = 1;
+  }
+  return key;
+}
+
+std::size_t checksum_index_t::probe(const key_t& key) const
+{
+  std::size_t mask = slots.size() - 1;
+  std::size_t i    = hash_key(key) & mask;
+
+  while (slots[i].used && ! (slots[i].key == key))
+    i = (i + 1) & mask;
+
+  return i;
+}
+
+void checksum_index_t::grow()
+{
+  std::vector<slot_t> old_slots;
+  old_slots.swap(slots);
+  slots.resize(old_slots.empty() ? 64 : old_slots.size() * 2);
+
+  foreach (const slot_t& slot, old_slots)
+    if (slot.used)
+      slots[probe(slot.key)] = slot;
+
+  DEBUG("checksum.index", "Grew UUID index to " << slots.size() << " slots");
+}
+
+std::pair<xact_t *, bool>
+checksum_index_t::insert(const key_t& key, xact_t * xact)
+{
+  // Keep the table at most half full, so that probe sequences are short
+  if ((count + 1) * 2 > slots.size())
+    grow();
+
+  slot_t& slot(slots[probe(key)]);
+  if (slot.used)
+    return std::pair<xact_t *, bool>(slot.xact, false);
+
+  slot.key  = key;
+  slot.xact = xact;
+  slot.used = true;
+  count++;
+
+  return std::pair<xact_t *, bool>(xact, true);
+}
+
+void checksum_index_t::merge(const checksum_index_t& other)
+{
+  foreach (const slot_t& slot, other.slots)
+    if (slot.used)
+      insert(slot.key, slot.xact);
+}
+
+std::size_t checksum_index_t::load(const path& pathname)
+{
+  if (! exists(pathname))
+    return 0;
+
+  if (file_size(pathname) < header_size)
+    throw_(checksum_error,
+           _f("UUID index %1% is too short") % pathname);
+
+  boost::iostreams::mapped_file_source file(pathname.string());
+
+  const char * data = file.data();
+  uint32_t     version;
+  std::memcpy(&version, data + sizeof(index_magic), sizeof(version));
+
+  if (std::memcmp(data, index_magic, sizeof(index_magic)) != 0 ||
+      version != index_version)
+    throw_(checksum_error,
+           _f("%1% is not a UUID index for this version of Ledger")
+           % pathname);
+
+  // A record that was only partly appended is ignored, and overwritten
+  // by the next append()
+  std::size_t records = (file.size() - header_size) / sizeof(key_t);
+  data += header_size;
+
+  for (std::size_t i = 0; i < records; i++, data += sizeof(key_t)) {
+    key_t key;
+    std::memcpy(&key, data, sizeof(key));
+    insert(key, NULL);
+  }
+
+  DEBUG("checksum.index",
+        "Read " << records << " UUIDs from index " << pathname);
+  return header_size + records * sizeof(key_t);
+}
+
+void checksum_index_t::save(const path& pathname) const
+{
+  std::vector<key_t> keys;
+  keys.reserve(count);
+  foreach (const slot_t& slot, slots)
+    if (slot.used)
+      keys.push_back(slot.key);
+
+  path temp_file(pathname.string() + ".tmp");
+  {
+    ofstream out(temp_file, std::ios::out | std::ios::binary |
+                 std::ios::trunc);
+    out.write(index_magic, sizeof(index_magic));
+    out.write(reinterpret_cast<const char *>(&index_version),
+              sizeof(index_version));
+    write_keys(out, keys);
+
+    if (! out.good())
+      throw_(checksum_error, _f("Could not write %1%") % temp_file);
+  }
+  rename(temp_file, pathname);
+
+  DEBUG("checksum.index",
+        "Wrote " << keys.size() << " UUIDs to index " << pathname);
+}
+
+void checksum_index_t::append(const path&               pathname,
+                              const std::size_t         length,
+                              const std::vector<key_t>& keys)
+{
+  if (file_size(pathname) != length) {
+    DEBUG("checksum.index", "Cutting index " << pathname
+          << " back to its last whole record at " << length << " bytes");
+    resize_file(pathname, length);
+  }
+
+  ofstream out(pathname, std::ios::out | std::ios::binary | std::ios::app);
+  write_keys(out, keys);
+
+  if (! out.good())
+    throw_(checksum_error, _f("Could not write %1%") % pathname);
+
+  DEBUG("checksum.index",
+        "Appended " << keys.size() << " UUIDs to index " << pathname);
+}
+
+} // namespace ledger
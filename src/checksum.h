@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @addtogroup data
+ */
+
+/**
+ * @file   checksum.h
+ * @author John Wiegley
+ *
+ * @ingroup data
+ *
+ * @brief  An index of transaction UUIDs keyed by binary digest
+ */
+#ifndef _CHECKSUM_H
+#define _CHECKSUM_H
+
+#include "utils.h"
+
+namespace ledger {
+
+class xact_t;
+
+DECLARE_EXCEPTION(checksum_error, std::runtime_error);
+
+/**
+ * @brief Maps transaction UUIDs to the transactions that carry them.
+ *
+ * UUIDs are normally the hexadecimal SHA1 digests written by
+ * `convert`, so they are stored as the 160 bits they spell rather than
+ * as strings.  Any other UUID is stored as the SHA1 digest of its text,
+ * with a flag that keeps it apart from a hexadecimal UUID of the same
+ * bits.  Keys live in an open-addressing table with linear probing.
+ *
+ * The keys can also be written to a file and read back without their
+ * transactions, which lets `convert` recognize rows imported by earlier
+ * runs without parsing the journals they went into.
+ */
+class checksum_index_t : public noncopyable
+{
+public:
+  struct key_t
+  {
+    boost::uint32_t digest[5];
+    boost::uint32_t hashed;
+
+    bool operator==(const key_t& other) const {
+      return std::memcmp(this, &other, sizeof(key_t)) == 0;
+    }
+  };
+
+private:
+  struct slot_t
+  {
+    key_t    key;
+    xact_t * xact;
+    bool     used;
+  };
+
+  std::vector<slot_t> slots;
+  std::size_t         count;
+
+  std::size_t probe(const key_t& key) const;
+  void        grow();
+
+public:
+  checksum_index_t() : count(0) {
+    TRACE_CTOR(checksum_index_t, "");
+  }
+  ~checksum_index_t() {
+    TRACE_DTOR(checksum_index_t);
+  }
+
+  static key_t make_key(const string& uuid);
+
+  /**
+   * Record that XACT carries KEY.  If the key was already present,
+   * returns the transaction recorded for it and false; that
+   * transaction is NULL for keys read from a file.
+   */
+  std::pair<xact_t *, bool> insert(const key_t& key, xact_t * xact);
+  std::pair<xact_t *, bool> insert(const string& uuid, xact_t * xact) {
+    return insert(make_key(uuid), xact);
+  }
+
+  bool contains(const key_t& key) const {
+    return count > 0 && slots[probe(key)].used;
+  }
+  bool contains(const string& uuid) const {
+    return contains(make_key(uuid));
+  }
+
+  /**
+   * Add every key of OTHER that is not yet in this index.
+   */
+  void merge(const checksum_index_t& other);
+
+  std::size_t size() const {
+    return count;
+  }
+  bool empty() const {
+    return count == 0;
+  }
+  void clear() {
+    slots.clear();
+    count = 0;
+  }
+
+  /**
+   * Add the keys stored in PATHNAME.  Returns the length of the file up
+   * to the end of its last whole record, to be passed to append(), or
+   * 0 if the file does not exist.
+   */
+  std::size_t load(const path& pathname);
+
+  /**
+   * Replace PATHNAME with a file holding every key in the index.
+   */
+  void save(const path& pathname) const;
+
+  /**
+   * Add KEYS to a file previously written by save(), after the first
+   * LENGTH bytes returned by load().  Anything beyond that, such as a
+   * record only partly written by an interrupted run, is cut off first
+   * so that the new keys stay aligned.
+   */
+  static void append(const path& pathname, std::size_t length,
+                     const std::vector<key_t>& keys);
+};
+
+} // namespace ledger
+
+#endif // _CHECKSUM_H
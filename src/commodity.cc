@@ -59,7 +59,7 @@ void commodity_t::add_price(const datetime_t& date, const amount_t& price,
 
   pool().commodity_price_history.add_price(referent(), date, price);
 
-  base->price_map.clear();    // a price was added, invalid the map
+  base->clear_price_map();    // a price was added, invalid the map
 }
 
 void commodity_t::remove_price(const datetime_t& date, commodity_t& commodity)
@@ -68,7 +68,7 @@ void commodity_t::remove_price(const datetime_t& date, commodity_t& commodity)
 
   DEBUG("history.find", "Removing price: " << symbol() << " on " << date);
 
-  base->price_map.clear();  // a price was added, invalid the map
+  base->clear_price_map();  // a price was removed, invalid the map
 }
 
 void commodity_t::map_prices(function<void(datetime_t, const amount_t&)> fn,
@@ -131,32 +131,52 @@ commodity_t::find_price(const commodity_t * commodity,
   if (target && this == target)
     return none;
 
-  base_t::memoized_price_entry entry(moment, oldest,
-                                     commodity ? commodity : NULL);
+  datetime_t when;
+  if (! moment.is_not_a_date_time())
+    when = moment;
+  else if (epoch)
+    when = *epoch;
+  else
+    when = CURRENT_TIME();
+
+  if (base->value_expr)
+    return find_price_from_expr(*base->value_expr, commodity, when);
+
+  // The price history gives the same answer for any moment up to the
+  // next price point, so remember prices by the latest price point
+  // instead of by the exact moment asked for.
+  optional<datetime_t> since =
+    pool().commodity_price_history.last_price_moment(when);
+  if (! since) {
+    DEBUG("commodity.price.find", "no prices before " << when);
+    return none;
+  }
+
+  // not_a_date_time does not order against other times, so an open
+  // oldest date is remembered as negative infinity.
+  base_t::memoized_price_entry
+    entry(*since, (oldest.is_not_a_date_time() ?
+                   datetime_t(boost::posix_time::neg_infin) : oldest),
+          commodity ? commodity : NULL);
 
   DEBUG("commodity.price.find", "looking for memoized args: "
-        << (! moment.is_not_a_date_time() ? format_datetime(moment) : "NONE") << ", "
+        << format_datetime(*since) << ", "
         << (! oldest.is_not_a_date_time() ? format_datetime(oldest) : "NONE") << ", "
         << (commodity ? commodity->symbol()      : "NONE"));
   {
     base_t::memoized_price_map::iterator i = base->price_map.find(entry);
     if (i != base->price_map.end()) {
+      pool().price_map_hits++;
+      base->price_list.splice(base->price_list.begin(), base->price_list,
+                              (*i).second);
       DEBUG("commodity.price.find", "found! returning: "
-            << ((*i).second ? (*i).second->price : amount_t(0L)));
-      return (*i).second;
+            << ((*(*i).second).second ?
+                (*(*i).second).second->price : amount_t(0L)));
+      return (*(*i).second).second;
     }
   }
 
-  datetime_t when;
-  if (! moment.is_not_a_date_time())
-    when = moment;
-  else if (epoch)
-    when = *epoch;
-  else
-    when = CURRENT_TIME();
-
-  if (base->value_expr)
-    return find_price_from_expr(*base->value_expr, commodity, when);
+  pool().price_map_misses++;
 
   optional<price_point_t>
     point(target ?
@@ -164,17 +184,23 @@ commodity_t::find_price(const commodity_t * commodity,
                                                     when, oldest) :
           pool().commodity_price_history.find_price(referent(), when, oldest));
 
-  // Record this price point in the memoization map
-  if (base->price_map.size() > base_t::max_price_map_size) {
-    DEBUG("history.find",
-          "price map has grown too large, clearing it by half");
-    for (std::size_t i = 0; i < base_t::max_price_map_size >> 1; i++)
-      base->price_map.erase(base->price_map.begin());
+  // Record this price point in the memoization map, forgetting the least
+  // recently used one if the map is full
+  if (base->price_map.size() >= base_t::max_price_map_size) {
+    pool().price_map_evictions++;
+    base->price_map.erase(base->price_list.back().first);
+    base->price_list.pop_back();
   }
 
   DEBUG("history.find",
         "remembered: " << (point ? point->price : amount_t(0L)));
-  base->price_map.insert(base_t::memoized_price_map::value_type(entry, point));
+  base->price_list.push_front(std::make_pair(entry, point));
+  base->price_map.insert
+    (base_t::memoized_price_map::value_type(entry, base->price_list.begin()));
+
+  DEBUG("commodity.price.find", "price map hits " << pool().price_map_hits
+        << ", misses " << pool().price_map_misses
+        << ", evictions " << pool().price_map_evictions);
 
   return point;
 }
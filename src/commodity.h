@@ -105,13 +105,19 @@ protected:
     optional<amount_t>    larger;
     optional<expr_t>      value_expr;
 
+    // Remembered prices are kept in least-recently-used order, most
+    // recent first, with price_map indexing into price_list.
     typedef tuple<datetime_t, datetime_t,
                   const commodity_t *> memoized_price_entry;
+    typedef std::list<std::pair<memoized_price_entry,
+                                optional<price_point_t> > >
+      memoized_price_list;
     typedef std::map<memoized_price_entry,
-                     optional<price_point_t> > memoized_price_map;
+                     memoized_price_list::iterator> memoized_price_map;
 
-    static const std::size_t   max_price_map_size = 8;
-    mutable memoized_price_map price_map;
+    static const std::size_t    max_price_map_size = 64;
+    mutable memoized_price_list price_list;
+    mutable memoized_price_map  price_map;
 
   public:
     explicit base_t(const string& _symbol)
@@ -125,6 +131,11 @@ protected:
     virtual ~base_t() {
       TRACE_DTOR(commodity_t::base_t);
     }
+
+    void clear_price_map() {
+      price_list.clear();
+      price_map.clear();
+    }
   };
 
   shared_ptr<base_t> base;
@@ -56,9 +56,27 @@ value_t convert_command(call_scope_t& args)
   account_t * bucket  = journal.master->find_account(bucket_name);
   account_t * unknown = journal.master->find_account(_("Expenses:Unknown"));
 
-  // Create a flat list
+  // Create a flat list, and index its payees once for guessing the
+  // accounts of imported transactions
   xacts_list current_xacts(journal.xacts_begin(), journal.xacts_end());
 
+  unique_ptr<payee_index_t> payees;
+  if (report.HANDLED(auto_match))
+    payees.reset(new payee_index_t(current_xacts.rbegin(),
+                                   current_xacts.rend()));
+
+  // UUIDs of rows imported by earlier runs, which need not be part of
+  // the journal that was read
+  checksum_index_t                     imported;
+  std::vector<checksum_index_t::key_t> imported_keys;
+  optional<path>                       index_file;
+  std::size_t                          index_length = 0;
+
+  if (report.HANDLED(uuid_index_)) {
+    index_file   = resolve_path(report.HANDLER(uuid_index_).str());
+    index_length = imported.load(*index_file);
+  }
+
   // Read in the series of transactions from the CSV file
 
   print_xacts formatter(report);
@@ -82,8 +100,8 @@ value_t convert_command(call_scope_t& args)
                     xact->get_tag(_("UUID"))->to_string() :
                     sha1sum(reader.get_last_line()));
 
-      checksum_map_t::const_iterator entry = journal.checksum_map.find(ref);
-      if (entry != journal.checksum_map.end()) {
+      checksum_index_t::key_t key = checksum_index_t::make_key(ref);
+      if (journal.checksum_map.contains(key) || imported.contains(key)) {
         INFO(file_context(reader.get_pathname(),
                           reader.get_linenum())
              << " " << "Ignoring known UUID " << ref);
@@ -96,10 +114,7 @@ value_t convert_command(call_scope_t& args)
 
       if (xact->posts.front()->account == NULL) {
         if (account_t * acct =
-            (report.HANDLED(auto_match) ?
-             lookup_probable_account(xact->payee, current_xacts.rbegin(),
-                                     current_xacts.rend(), bucket).second :
-             NULL))
+            (payees ? payees->find(xact->payee, bucket).second : NULL))
           xact->posts.front()->account = acct;
         else
           xact->posts.front()->account = unknown;
@@ -111,6 +126,9 @@ value_t convert_command(call_scope_t& args)
                _("Failed to finalize derived transaction (check commodities)"));
       }
       else {
+        if (index_file)
+          imported_keys.push_back(key);
+
         xact_posts_iterator xact_iter(*xact);
         while (post_t * post = *xact_iter++)
           formatter(*post);
@@ -127,6 +145,21 @@ value_t convert_command(call_scope_t& args)
     throw;
   }
 
+  // Record what was imported.  The output is flushed first, so that the
+  // index never names a transaction which was not written out.
+  if (index_file) {
+    report.output_stream.flush();
+
+    if (index_length > 0) {
+      checksum_index_t::append(*index_file, index_length, imported_keys);
+    } else {
+      imported.merge(journal.checksum_map);
+      foreach (const checksum_index_t::key_t& key, imported_keys)
+        imported.insert(key, NULL);
+      imported.save(*index_file);
+    }
+  }
+
   // If not, transform the payee according to regexps
 
   // Set the account to a default vaule, then transform the account according
@@ -40,71 +40,151 @@
 
 namespace ledger {
 
-string csv_reader::read_field(std::istream& in)
+namespace {
+  /**
+   * Return the first position in [p, end) holding one of the bytes a,
+   * b or c, or end if there is none.  Eight bytes are tested at a time
+   * using the "word has a zero byte" trick, so only the word holding a
+   * match is ever looked at byte by byte.
+   */
+  const char * find_first_of(const char * p, const char * end,
+                             const char a, const char b, const char c)
+  {
+    const boost::uint64_t ones  = 0x0101010101010101ULL;
+    const boost::uint64_t highs = 0x8080808080808080ULL;
+    const boost::uint64_t ma    = ones * static_cast<unsigned char>(a);
+    const boost::uint64_t mb    = ones * static_cast<unsigned char>(b);
+    const boost::uint64_t mc    = ones * static_cast<unsigned char>(c);
+
+    while (end - p >= 8) {
+      boost::uint64_t word;
+      std::memcpy(&word, p, sizeof(word));
+      boost::uint64_t xa = word ^ ma, xb = word ^ mb, xc = word ^ mc;
+      if ((((xa - ones) & ~xa) |
+           ((xb - ones) & ~xb) |
+           ((xc - ones) & ~xc)) & highs)
+        break;
+      p += 8;
+    }
+    while (p < end && *p != a && *p != b && *p != c)
+      ++p;
+    return p;
+  }
+}
+
+bool csv_reader::read_field(const char *& p, const char * end)
 {
-  string field;
-
-  char c;
-  if (in.peek() == '"' || in.peek() == '|') {
-    in.get(c);
-    char x;
-    while (in.good() && ! in.eof()) {
-      in.get(x);
+  bool more = false;
+
+  field.clear();
+
+  if (p < end && (*p == '"' || *p == '|')) {
+    const char c = *p++;
+    while (p < end) {
+      // Copy everything up to the next quote or escape in one piece
+      const char * q = find_first_of(p, end, c, '"', '\\');
+      field.append(p, q);
+      if ((p = q) == end)
+        break;
+
+      char x = *p++;
       if (x == '\\') {
-        in.get(x);
+        if (p == end)
+          break;
+        x = *p++;
       }
-      else if (x == '"' && in.peek() == '"') {
-        in.get(x);
+      else if (x == '"' && p < end && *p == '"') {
+        p++;
       }
       else if (x == c) {
         if (x == '|')
-          in.unget();
-        else if (in.peek() == ',')
-          in.get(c);
+          p--;
+        else if (p < end && *p == ',') {
+          p++;
+          more = true;
+        }
         break;
       }
-      if (x != '\0')
-        field += x;
+      field += x;
     }
+    more = more || p < end;
   }
   else {
-    while (in.good() && ! in.eof()) {
-      in.get(c);
-      if (in.good()) {
-        if (c == ',')
-          break;
-        if (c != '\0')
-          field += c;
-      }
+    const char * q =
+      static_cast<const char *>(std::memchr(p, ',', std::size_t(end - p)));
+    if (q) {
+      field.assign(p, q);
+      p    = q + 1;
+      more = true;
+    } else {
+      field.assign(p, end);
+      p    = end;
     }
   }
   trim(field);
-  return field;
+  return more;
 }
 
-char * csv_reader::next_line(std::istream& in)
+bool csv_reader::next_line(const char *& line, const char *& line_end)
 {
-  while (in.good() && ! in.eof() && in.peek() == '#')
-    in.getline(context.linebuf, parse_context_t::MAX_LINE);
+  std::istream& in(*context.stream.get());
+
+  while (true) {
+    const char * begin = &buffer[0] + buffer_pos;
+    const char * nl    = static_cast<const char *>
+      (std::memchr(begin, '\n', buffer_end - buffer_pos));
+
+    if (! nl && ! at_eof) {
+      // Move the partial line to the front and read the next chunk
+      // after it, growing the buffer if a single line fills it.
+      if (buffer_pos > 0) {
+        std::memmove(&buffer[0], begin, buffer_end - buffer_pos);
+        buffer_end -= buffer_pos;
+        buffer_pos  = 0;
+      }
+      if (buffer_end == buffer.size())
+        buffer.resize(buffer.size() * 2);
+
+      in.read(&buffer[buffer_end],
+              static_cast<std::streamsize>(buffer.size() - buffer_end));
+      buffer_end += static_cast<std::size_t>(in.gcount());
+      if (! in.good())
+        at_eof = true;
+      continue;
+    }
 
-  if (! in.good() || in.eof() || in.peek() == -1)
-    return NULL;
+    if (buffer_pos == buffer_end)
+      return false;
+
+    std::size_t len  = nl ? std::size_t(nl - begin) : buffer_end - buffer_pos;
+    std::size_t used = nl ? len + 1 : len;
+
+    buffer_pos += used;
+    if (context.curr_pos != istream_pos_type(-1))
+      context.curr_pos += std::streamoff(used);
+
+    if (*begin == '#')
+      continue;
 
-  in.getline(context.linebuf, parse_context_t::MAX_LINE);
+    // The fields are split in place, so the line stays valid only until
+    // the next call
+    line     = begin;
+    line_end = begin + len;
+    last_line.assign(line, line_end);
 
-  return context.linebuf;
+    return true;
+  }
 }
 
-void csv_reader::read_index(std::istream& in)
+void csv_reader::read_index()
 {
-  char * line = next_line(in);
-  if (! line)
+  const char * p;
+  const char * end;
+  if (! next_line(p, end))
     return;
 
-  std::istringstream instr(line);
-
-  while (instr.good() && ! instr.eof()) {
-    string field = read_field(instr);
+  for (bool more = true; more; ) {
+    more = read_field(p, end);
     names.push_back(field);
 
     if (date_mask.match(field))
@@ -132,13 +212,12 @@ void csv_reader::read_index(std::istream& in)
 
 xact_t * csv_reader::read_xact(bool rich_data)
 {
-  char * line = next_line(*context.stream.get());
-  if (! line || index.empty())
+  const char * p;
+  const char * end;
+  if (! next_line(p, end) || index.empty())
     return NULL;
   context.linenum++;
 
-  std::istringstream instr(line);
-
   unique_ptr<xact_t> xact(new xact_t);
   unique_ptr<post_t> post(new post_t);
 
@@ -146,7 +225,7 @@ xact_t * csv_reader::read_xact(bool rich_data)
 
   xact->pos           = position_t();
   xact->pos->pathname = context.pathname;
-  xact->pos->beg_pos  = context.stream->tellg();
+  xact->pos->beg_pos  = context.curr_pos;
   xact->pos->beg_line = context.linenum;
   xact->pos->sequence = context.sequence++;
 
@@ -154,7 +233,7 @@ xact_t * csv_reader::read_xact(bool rich_data)
 
   post->pos           = position_t();
   post->pos->pathname = context.pathname;
-  post->pos->beg_pos  = context.stream->tellg();
+  post->pos->beg_pos  = context.curr_pos;
   post->pos->beg_line = context.linenum;
   post->pos->sequence = context.sequence++;
 
@@ -164,10 +243,9 @@ xact_t * csv_reader::read_xact(bool rich_data)
   std::vector<int>::size_type n = 0;
   amount_t amt;
   string total;
-  string field;
 
-  while (instr.good() && ! instr.eof() && n < index.size()) {
-    field = read_field(instr);
+  for (bool more = true; more && n < index.size(); ) {
+    more = read_field(p, end);
 
     switch (index[n]) {
     case FIELD_DATE:
@@ -184,20 +262,15 @@ xact_t * csv_reader::read_xact(bool rich_data)
         xact->code = field;
       break;
 
-    case FIELD_PAYEE: {
-      bool found = false;
-      foreach (payee_alias_mapping_t& value, context.journal->payee_alias_mappings) {
-        DEBUG("csv.mappings", "Looking for payee mapping: " << value.first);
-        if (value.first.match(field)) {
-          xact->payee = value.second;
-          found = true;
-          break;
-        }
-      }
-      if (! found)
+    case FIELD_PAYEE:
+      if (payee_alias_mapping_t * value =
+          context.journal->find_payee_alias(field)) {
+        DEBUG("csv.mappings", "Found payee mapping: " << value->first);
+        xact->payee = value->second;
+      } else {
         xact->payee = field;
+      }
       break;
-    }
 
     case FIELD_AMOUNT: {
       std::istringstream amount_str(field);
@@ -240,16 +313,15 @@ xact_t * csv_reader::read_xact(bool rich_data)
   if (rich_data) {
     xact->set_tag(_("Imported"),
                   string_value(format_date(CURRENT_DATE(), FMT_WRITTEN)));
-    xact->set_tag(_("CSV"), string_value(line));
+    xact->set_tag(_("CSV"), string_value(last_line));
   }
 
   // Translate the account name, if we have enough information to do so
 
-  foreach (account_mapping_t& value, context.journal->payees_for_unknown_accounts) {
-    if (value.first.match(xact->payee)) {
-      post->account = value.second;
-      break;
-    }
+  if (account_mapping_t * value =
+      context.journal->find_payee_account(xact->payee)) {
+    DEBUG("csv.mappings", "Found account mapping: " << value->first);
+    post->account = value->second;
   }
 
   xact->add_post(post.release());
@@ -262,7 +334,7 @@ xact_t * csv_reader::read_xact(bool rich_data)
 
   post->pos           = position_t();
   post->pos->pathname = context.pathname;
-  post->pos->beg_pos  = context.stream->tellg();
+  post->pos->beg_pos  = context.curr_pos;
   post->pos->beg_line = context.linenum;
   post->pos->sequence = context.sequence++;
 
@@ -80,6 +80,16 @@ class csv_reader
   std::vector<int>    index;
   std::vector<string> names;
 
+  // The input is read in large chunks and split into lines and fields
+  // in memory, rather than one character at a time from the stream.
+  // Lines have no length limit; the last one is kept whole in last_line.
+  std::vector<char>   buffer;
+  std::size_t         buffer_pos;
+  std::size_t         buffer_end;
+  bool                at_eof;
+  string              field;
+  string              last_line;
+
 public:
   csv_reader(parse_context_t& _context)
     : context(_context),
@@ -90,22 +100,26 @@ public:
       amount_mask("amount"),
       cost_mask("cost"),
       total_mask("total"),
-      note_mask("note") {
-    read_index(*context.stream.get());
+      note_mask("note"),
+      buffer(CHUNK_SIZE), buffer_pos(0), buffer_end(0), at_eof(false) {
+    context.curr_pos = context.stream->tellg();
+    read_index();
     TRACE_CTOR(csv_reader, "parse_context_t&");
   }
   ~csv_reader() {
     TRACE_DTOR(csv_reader);
   }
 
-  void   read_index(std::istream& in);
-  string read_field(std::istream& in);
-  char * next_line(std::istream& in);
+  static const std::size_t CHUNK_SIZE = 65536;
+
+  void   read_index();
+  bool   read_field(const char *& p, const char * end);
+  bool   next_line(const char *& begin, const char *& end);
 
   xact_t * read_xact(bool rich_data);
 
-  const char * get_last_line() const {
-    return context.linebuf;
+  const string& get_last_line() const {
+    return last_line;
   }
   path get_pathname() const {
     return context.pathname;
@@ -42,7 +42,8 @@ expr_t::expr_t() : base_type()
   TRACE_CTOR(expr_t, "");
 }
 
-expr_t::expr_t(const expr_t& other) : base_type(other), ptr(other.ptr)
+expr_t::expr_t(const expr_t& other)
+  : base_type(other), ptr(other.ptr), program(other.program)
 {
   TRACE_CTOR(expr_t, "copy");
 }
@@ -75,7 +76,8 @@ expr_t& expr_t::operator=(const expr_t& _expr)
 {
   if (this != &_expr) {
     base_type::operator=(_expr);
-    ptr = _expr.ptr;
+    ptr     = _expr.ptr;
+    program = _expr.program;
   }
   return *this;
 }
@@ -96,6 +98,7 @@ void expr_t::parse(std::istream& in, const parse_flags_t& flags,
   parser_t parser;
   istream_pos_type start_pos = in.tellg();
   ptr = parser.parse(in, flags, original_string);
+  program.reset();
   istream_pos_type end_pos = in.tellg();
 
   if (original_string) {
@@ -116,10 +119,17 @@ void expr_t::parse(std::istream& in, const parse_flags_t& flags,
   }
 }
 
+void expr_t::mark_uncompiled()
+{
+  base_type::mark_uncompiled();
+  program.reset();
+}
+
 void expr_t::compile(scope_t& scope)
 {
   if (! compiled && ptr) {
-    ptr = ptr->compile(scope);
+    ptr     = ptr->compile(scope);
+    program = program_t::compile(ptr);
     base_type::compile(scope);
   }
 }
@@ -129,7 +139,12 @@ value_t expr_t::real_calc(scope_t& scope)
   if (ptr) {
     ptr_op_t locus;
     try {
-      return ptr->calc(scope, &locus);
+      // The tree walker is used whenever its evaluation trace has been
+      // asked for, since the program does not produce one.
+      if (compiled && program && ! SHOW_DEBUG("expr.calc"))
+        return program->run(scope, &locus);
+      else
+        return ptr->calc(scope, &locus);
     }
     catch (const std::exception&) {
       if (locus) {
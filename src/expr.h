@@ -55,6 +55,7 @@ class expr_t : public expr_base_t<value_t>
 public:
   struct token_t;
   class op_t;
+  class program_t;
   typedef intrusive_ptr<op_t>       ptr_op_t;
   typedef intrusive_ptr<const op_t> const_ptr_op_t;
 
@@ -68,7 +69,8 @@ public:
   typedef std::list<check_expr_pair>           check_expr_list;
 
 protected:
-  ptr_op_t ptr;
+  ptr_op_t              ptr;
+  shared_ptr<program_t> program;
 
 public:
   expr_t();
@@ -94,6 +96,7 @@ public:
   virtual void    parse(std::istream&           in,
                         const parse_flags_t&    flags           = PARSE_DEFAULT,
                         const optional<string>& original_string = none);
+  virtual void    mark_uncompiled();
   virtual void    compile(scope_t& scope);
   virtual value_t real_calc(scope_t& scope);
 
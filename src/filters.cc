@@ -834,30 +834,20 @@ void changed_value_posts::operator()(post_t& post)
 void subtotal_posts::report_subtotal(const char *                     spec_fmt,
                                      const optional<date_interval_t>& interval)
 {
-  if (component_posts.empty())
+  if (! first_date)
     return;
 
   optional<date_t> range_start  = interval ? interval->start : none;
   optional<date_t> range_finish = interval ? interval->inclusive_end() : none;
 
-  if (! range_start || ! range_finish) {
-    foreach (post_t * post, component_posts) {
-      date_t date       = post->date();
-      date_t value_date = post->value_date();
-#if defined(__GNUC__) && __GNUC__ >= 4 && __GNUC_MINOR__ >= 7
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif
-      if (! range_start || date < *range_start)
-        range_start = date;
-      if (! range_finish || value_date > *range_finish)
-        range_finish = value_date;
-#if defined(__GNUC__) && __GNUC__ >= 4 && __GNUC_MINOR__ >= 7
-#pragma GCC diagnostic pop
-#endif
-    }
-  }
-  component_posts.clear();
+  if (! range_start)
+    range_start = first_date;
+  if (! range_finish)
+    range_finish = last_value_date;
+
+  first_date      = none;
+  last_date       = none;
+  last_value_date = none;
 
   std::ostringstream out_date;
   if (spec_fmt) {
@@ -875,9 +865,11 @@ void subtotal_posts::report_subtotal(const char *                     spec_fmt,
   xact.payee = out_date.str();
   xact._date = *range_start;
 
-  foreach (values_map::value_type& pair, values)
-    handle_value(/* value=      */ pair.second.value,
-                 /* account=    */ pair.second.account,
+  sort_values();
+
+  foreach (acct_value_t& value, values)
+    handle_value(/* value=      */ value.value,
+                 /* account=    */ value.account,
                  /* xact=       */ &xact,
                  /* temps=      */ temps,
                  /* handler=    */ handler,
@@ -887,9 +879,86 @@ void subtotal_posts::report_subtotal(const char *                     spec_fmt,
   values.clear();
 }
 
+void subtotal_posts::sort_values()
+{
+  // Positions are about to change, so forget them
+  foreach (acct_value_t& value, values)
+    value_slots[value.account->id] = 0;
+
+  // Distinct accounts may have the same name, such as a temporary account
+  // standing in for a real one; they are reported as one, under the
+  // account seen first.
+  std::stable_sort(values.begin(), values.end());
+
+  values_list::iterator last = values.end();
+  for (values_list::iterator i = values.begin(); i != values.end(); ++i) {
+    if (last != values.end() &&
+        (*last).account->fullname() == (*i).account->fullname()) {
+      if ((*i).is_virtual != (*last).is_virtual)
+        throw_(std::logic_error,
+               _("'equity' cannot accept virtual and "
+                 "non-virtual postings to the same account"));
+      add_or_set_value((*last).value, (*i).value);
+    } else {
+      last = last == values.end() ? values.begin() : last + 1;
+      if (last != i)
+        *last = *i;
+    }
+  }
+  if (last != values.end())
+    values.erase(last + 1, values.end());
+}
+
+void subtotal_posts::add_dates(const date_t& date, const date_t& value_date)
+{
+  if (! first_date || date < *first_date)
+    first_date = date;
+  if (! last_date || date > *last_date)
+    last_date = date;
+  if (! last_value_date || value_date > *last_value_date)
+    last_value_date = value_date;
+}
+
+void subtotal_posts::add_value(account_t * acct, const value_t& amount,
+                               bool is_virtual, bool must_balance)
+{
+  if (value_slots.size() <= acct->id)
+    value_slots.resize(acct->id + 1);
+  std::size_t& slot(value_slots[acct->id]);
+
+  acct_value_t * subtotal = NULL;
+  if (slot && values[slot - 1].account == acct) {
+    subtotal = &values[slot - 1];
+  }
+  else if (slot) {
+    // An account from outside the journal's tree may share the id of one
+    // already seen
+    foreach (acct_value_t& value, values) {
+      if (value.account == acct) {
+        subtotal = &value;
+        break;
+      }
+    }
+  }
+
+  if (! subtotal) {
+    values.push_back(acct_value_t(acct, is_virtual, must_balance));
+    values.back().value = amount;
+    if (! slot)
+      slot = values.size();
+  } else {
+    if (is_virtual != subtotal->is_virtual)
+      throw_(std::logic_error,
+             _("'equity' cannot accept virtual and "
+               "non-virtual postings to the same account"));
+
+    add_or_set_value(subtotal->value, amount);
+  }
+}
+
 void subtotal_posts::operator()(post_t& post)
 {
-  component_posts.push_back(&post);
+  add_dates(post.date(), post.value_date());
 
   account_t * acct = post.reported_account();
   assert(acct);
@@ -908,26 +977,8 @@ void subtotal_posts::operator()(post_t& post)
   post.xdata().compound_value = amount;
   post.xdata().add_flags(POST_EXT_COMPOUND);
 
-  values_map::iterator i = values.find(acct->fullname());
-  if (i == values.end()) {
-#if DEBUG_ON
-    std::pair<values_map::iterator, bool> result =
-#endif
-      values.insert(values_pair
-                    (acct->fullname(),
-                     acct_value_t(acct, amount, post.has_flags(POST_VIRTUAL),
-                                  post.has_flags(POST_MUST_BALANCE))));
-#if DEBUG_ON
-    assert(result.second);
-#endif
-  } else {
-    if (post.has_flags(POST_VIRTUAL) != (*i).second.is_virtual)
-      throw_(std::logic_error,
-             _("'equity' cannot accept virtual and "
-               "non-virtual postings to the same account"));
-
-    add_or_set_value((*i).second.value, amount);
-  }
+  add_value(acct, amount, post.has_flags(POST_VIRTUAL),
+            post.has_flags(POST_MUST_BALANCE));
 
   // If the account for this post is all virtual, mark it as
   // such, so that `handle_value' can show "(Account)" for accounts
@@ -949,14 +1000,6 @@ void interval_posts::report_subtotal(const date_interval_t& ival)
     subtotal_posts::report_subtotal(NULL, ival);
 }
 
-namespace {
-  struct sort_posts_by_date {
-    bool operator()(post_t * left, post_t * right) const {
-      return left->date() < right->date();
-    }
-  };
-}
-
 void interval_posts::operator()(post_t& post)
 {
   // If there is a duration (such as weekly), we must generate the
@@ -964,7 +1007,43 @@ void interval_posts::operator()(post_t& post)
   // post falls within the reporting period.
 
   if (interval.duration) {
-    all_posts.push_back(&post);
+    date_t      date = post.date();
+    account_t * acct = post.reported_account();
+    assert(acct);
+
+    // Everything subtotal_posts would note about the posting, other than
+    // its amount, is noted now, so that only the sums need to be kept
+    value_t amount(post.amount);
+    post.xdata().compound_value = amount;
+    post.xdata().add_flags(POST_EXT_COMPOUND);
+
+    acct->xdata().add_flags(ACCOUNT_EXT_AUTO_VIRTUALIZE);
+    if (! post.has_flags(POST_VIRTUAL))
+      acct->xdata().add_flags(ACCOUNT_EXT_HAS_NON_VIRTUALS);
+    else if (! post.has_flags(POST_MUST_BALANCE))
+      acct->xdata().add_flags(ACCOUNT_EXT_HAS_UNB_VIRTUALS);
+
+    std::pair<day_value_dates_map::iterator, bool> value_date =
+      day_value_dates.insert(day_value_dates_map::value_type
+                             (date, post.value_date()));
+    if (! value_date.second && post.value_date() > (*value_date.first).second)
+      (*value_date.first).second = post.value_date();
+
+    day_key_t key(date, day_account_t(acct->id, acct));
+    day_values_map::iterator i = day_values.find(key);
+    if (i == day_values.end()) {
+      day_values.insert(day_values_map::value_type
+                        (key, acct_value_t(acct, amount,
+                                           post.has_flags(POST_VIRTUAL),
+                                           post.has_flags(POST_MUST_BALANCE))));
+    } else {
+      if (post.has_flags(POST_VIRTUAL) != (*i).second.is_virtual)
+        throw_(std::logic_error,
+               _("'equity' cannot accept virtual and "
+                 "non-virtual postings to the same account"));
+
+      add_or_set_value((*i).second.value, amount);
+    }
   }
   else if (interval.find_period(post.date())) {
     item_handler<post_t>::operator()(post);
@@ -978,35 +1057,34 @@ void interval_posts::flush()
     return;
   }
 
-  // Sort all the postings we saw by date ascending
-  std::stable_sort(all_posts.begin(), all_posts.end(),
-                   sort_posts_by_date());
-
   // only if the interval has no start use the earliest post
   if (!(interval.begin() && interval.find_period(*interval.begin())))
     // Determine the beginning interval by using the earliest post
-    if (all_posts.size() > 0 && all_posts.front()
-        && !interval.find_period(all_posts.front()->date()))
+    if (! day_value_dates.empty() &&
+        ! interval.find_period((*day_value_dates.begin()).first))
       throw_(std::logic_error, _("Failed to find period for interval report"));
 
-  // Walk the interval forward reporting all posts within each one
-  // before moving on, until we reach the end of all_posts
+  // Walk the interval forward reporting the days within each one before
+  // moving on, until we reach the end of the days seen
   bool saw_posts = false;
-  for (std::deque<post_t *>::iterator i = all_posts.begin();
-       i != all_posts.end(); ) {
-    post_t * post(*i);
+  for (day_values_map::iterator i = day_values.begin();
+       i != day_values.end(); ) {
+    const date_t& date((*i).first.first);
 
     DEBUG("filters.interval",
-          "Considering post " << post->date() << " = " << post->amount);
+          "Considering " << date << ": " << (*i).second.account->fullname()
+          << " = " << (*i).second.value);
 #if DEBUG_ON
     DEBUG("filters.interval", "interval is:");
     debug_interval(interval);
 #endif
-    assert(! interval.finish || post->date() < *interval.finish);
+    assert(! interval.finish || date < *interval.finish);
 
-    if (interval.within_period(post->date())) {
-      DEBUG("filters.interval", "Calling subtotal_posts::operator()");
-      subtotal_posts::operator()(*post);
+    if (interval.within_period(date)) {
+      DEBUG("filters.interval", "Calling subtotal_posts::add_value()");
+      add_dates(date, day_value_dates[date]);
+      add_value((*i).second.account, (*i).second.value,
+                (*i).second.is_virtual, (*i).second.must_balance);
       ++i;
       saw_posts = true;
     } else {
@@ -1043,6 +1121,9 @@ void interval_posts::flush()
     report_subtotal(interval);
   }
 
+  day_values.clear();
+  day_value_dates.clear();
+
   // Tell our parent class to flush
   subtotal_posts::flush();
 }
@@ -1084,27 +1165,29 @@ namespace {
 void posts_as_equity::report_subtotal()
 {
   date_t finish;
-  foreach (post_t * post, component_posts) {
-    date_t date = post->date();
-    if (! is_valid(finish) || date > finish)
-      finish = date;
-  }
-  component_posts.clear();
+  if (last_date)
+    finish = *last_date;
+
+  first_date      = none;
+  last_date       = none;
+  last_value_date = none;
 
   xact_t& xact = temps.create_xact();
   xact.payee = _("Opening Balances");
   xact._date = finish;
 
+  sort_values();
+
   value_t total = 0L;
-  foreach (values_map::value_type& pair, values) {
-    value_t value(pair.second.value.strip_annotations(report.what_to_keep()));
+  foreach (acct_value_t& subtotal, values) {
+    value_t value(subtotal.value.strip_annotations(report.what_to_keep()));
     if (! value.is_zero()) {
       if (value.is_balance()) {
         foreach (const balance_t::amounts_map::value_type& amount_pair,
                  value.as_balance_lval().amounts) {
           if (! amount_pair.second.is_zero())
             handle_value(/* value=      */ amount_pair.second,
-                         /* account=    */ pair.second.account,
+                         /* account=    */ subtotal.account,
                          /* xact=       */ &xact,
                          /* temps=      */ temps,
                          /* handler=    */ handler,
@@ -1113,7 +1196,7 @@ void posts_as_equity::report_subtotal()
         }
       } else {
         handle_value(/* value=      */ value.to_amount(),
-                     /* account=    */ pair.second.account,
+                     /* account=    */ subtotal.account,
                      /* xact=       */ &xact,
                      /* temps=      */ temps,
                      /* handler=    */ handler,
@@ -1122,7 +1205,7 @@ void posts_as_equity::report_subtotal()
       }
     }
 
-    if (! pair.second.is_virtual || pair.second.must_balance)
+    if (! subtotal.is_virtual || subtotal.must_balance)
       total += value;
   }
   values.clear();
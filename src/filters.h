@@ -323,8 +323,8 @@ public:
 
 class filter_posts : public item_handler<post_t>
 {
-  predicate_t pred;
-  scope_t&    context;
+  post_predicate_t pred;
+  scope_t&         context;
 
   filter_posts();
 
@@ -340,8 +340,7 @@ public:
   }
 
   virtual void operator()(post_t& post) {
-    bind_scope_t bound_scope(context, post);
-    if (pred(bound_scope)) {
+    if (pred(post, context)) {
       post.xdata().add_flags(POST_EXT_MATCHES);
       (*handler)(post);
     }
@@ -667,17 +666,36 @@ protected:
     ~acct_value_t() throw() {
       TRACE_DTOR(acct_value_t);
     }
+
+    bool operator<(const acct_value_t& other) const {
+      return account->fullname() < other.account->fullname();
+    }
   };
 
-  typedef std::map<string, acct_value_t>  values_map;
-  typedef std::pair<string, acct_value_t> values_pair;
+  typedef std::vector<acct_value_t> values_list;
 
 protected:
   expr_t&              amount_expr;
-  values_map           values;
   optional<string>     date_format;
   temporaries_t        temps;
-  std::deque<post_t *> component_posts;
+
+  // The range of dates of the postings in the current subtotal
+  optional<date_t>     first_date;
+  optional<date_t>     last_date;
+  optional<date_t>     last_value_date;
+
+  // Subtotals in the order their accounts were first seen.  value_slots
+  // maps an account's id to one more than the position of its subtotal,
+  // so that both may be emptied and reused from one interval to the
+  // next; sort_values() puts them in account order for reporting.
+  values_list              values;
+  std::vector<std::size_t> value_slots;
+
+  void sort_values();
+
+  void add_dates(const date_t& date, const date_t& value_date);
+  void add_value(account_t * acct, const value_t& amount,
+                 bool is_virtual, bool must_balance);
 
 public:
   subtotal_posts(post_handler_ptr handler, expr_t& _amount_expr,
@@ -705,8 +723,11 @@ public:
   virtual void clear() {
     amount_expr.mark_uncompiled();
     values.clear();
+    value_slots.clear();
     temps.clear();
-    component_posts.clear();
+    first_date      = none;
+    last_date       = none;
+    last_value_date = none;
 
     item_handler<post_t>::clear();
   }
@@ -720,7 +741,18 @@ class interval_posts : public subtotal_posts
   bool            exact_periods;
   bool            generate_empty_posts;
 
-  std::deque<post_t *> all_posts;
+  // Postings are summed by day and account as they arrive, and the days
+  // gathered into the periods of the interval by flush(); every period
+  // is made of whole days, so this loses nothing the report shows.  An
+  // account's id orders it within the day, and its pointer separates
+  // accounts from other trees that share the id.
+  typedef std::pair<std::size_t, account_t *>   day_account_t;
+  typedef std::pair<date_t, day_account_t>      day_key_t;
+  typedef std::map<day_key_t, acct_value_t>     day_values_map;
+  typedef std::map<date_t, date_t>              day_value_dates_map;
+
+  day_values_map      day_values;
+  day_value_dates_map day_value_dates;
 
   interval_posts();
 
@@ -767,6 +799,8 @@ public:
 
   virtual void clear() {
     interval  = start_interval;
+    day_values.clear();
+    day_value_dates.clear();
 
     subtotal_posts::clear();
     create_accounts();
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @addtogroup util
+ */
+
+/**
+ * @file   flatmap.h
+ * @author John Wiegley
+ *
+ * @ingroup util
+ *
+ * @brief  A small sorted map which keeps its first entries inline
+ */
+#ifndef _FLATMAP_H
+#define _FLATMAP_H
+
+namespace ledger {
+
+/**
+ * @brief A sorted map of a few entries, stored contiguously.
+ *
+ * flat_map_t keeps its entries in a sorted array, which lives inside
+ * the object itself for up to N entries and moves to the heap once it
+ * grows beyond that.  Lookups are binary searches and iteration is a
+ * linear walk, in the same order a std::map with the same key would
+ * use.  It offers the subset of std::map's interface needed by
+ * balance_t; unlike std::map, inserting or erasing an entry invalidates
+ * iterators to the entries after it.
+ */
+template <typename Key, typename T, std::size_t N>
+class flat_map_t
+{
+public:
+  typedef Key                  key_type;
+  typedef T                    mapped_type;
+  typedef std::pair<Key, T>    value_type;
+  typedef value_type *         iterator;
+  typedef const value_type *   const_iterator;
+  typedef std::size_t          size_type;
+
+private:
+  typedef typename boost::aligned_storage
+    <sizeof(value_type) * N, boost::alignment_of<value_type>::value>::type
+    storage_t;
+
+  value_type * entries;
+  size_type    count;
+  size_type    capacity;
+  storage_t    storage;
+
+  value_type * inline_entries() {
+    return reinterpret_cast<value_type *>(&storage);
+  }
+
+  struct key_less {
+    bool operator()(const value_type& entry, const Key& key) const {
+      return entry.first < key;
+    }
+  };
+
+  void reserve(const size_type needed) {
+    if (needed <= capacity)
+      return;
+
+    size_type    new_capacity = std::max(needed, capacity * 2);
+    value_type * new_entries  = static_cast<value_type *>
+      (::operator new(sizeof(value_type) * new_capacity));
+    size_type    i = 0;
+    try {
+      for (; i < count; i++)
+        new (&new_entries[i]) value_type(entries[i]);
+    }
+    catch (...) {
+      while (i > 0)
+        new_entries[--i].~value_type();
+      ::operator delete(new_entries);
+      throw;
+    }
+    size_type old_count = count;
+    destroy();
+    entries  = new_entries;
+    count    = old_count;
+    capacity = new_capacity;
+  }
+
+  void destroy() {
+    for (size_type i = 0; i < count; i++)
+      entries[i].~value_type();
+    if (entries != inline_entries())
+      ::operator delete(entries);
+    entries  = inline_entries();
+    count    = 0;
+    capacity = N;
+  }
+
+public:
+  flat_map_t() : entries(inline_entries()), count(0), capacity(N) {}
+  flat_map_t(const flat_map_t& other)
+    : entries(inline_entries()), count(0), capacity(N) {
+    *this = other;
+  }
+  ~flat_map_t() {
+    destroy();
+  }
+
+  flat_map_t& operator=(const flat_map_t& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.count);
+      for (; count < other.count; count++)
+        new (&entries[count]) value_type(other.entries[count]);
+    }
+    return *this;
+  }
+
+  iterator begin() {
+    return entries;
+  }
+  iterator end() {
+    return entries + count;
+  }
+  const_iterator begin() const {
+    return entries;
+  }
+  const_iterator end() const {
+    return entries + count;
+  }
+
+  size_type size() const {
+    return count;
+  }
+  bool empty() const {
+    return count == 0;
+  }
+
+  void clear() {
+    destroy();
+  }
+
+  iterator find(const Key& key) {
+    iterator i = std::lower_bound(begin(), end(), key, key_less());
+    return (i != end() && ! (key < i->first)) ? i : end();
+  }
+  const_iterator find(const Key& key) const {
+    const_iterator i = std::lower_bound(begin(), end(), key, key_less());
+    return (i != end() && ! (key < i->first)) ? i : end();
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    size_type pos = static_cast<size_type>
+      (std::lower_bound(begin(), end(), value.first, key_less()) - begin());
+    if (pos < count && ! (value.first < entries[pos].first))
+      return std::pair<iterator, bool>(entries + pos, false);
+
+    reserve(count + 1);
+    if (pos == count) {
+      new (&entries[count]) value_type(value);
+    } else {
+      new (&entries[count]) value_type(entries[count - 1]);
+      for (size_type i = count - 1; i > pos; i--)
+        entries[i] = entries[i - 1];
+      entries[pos] = value;
+    }
+    count++;
+    return std::pair<iterator, bool>(entries + pos, true);
+  }
+
+  void erase(iterator i) {
+    assert(i >= begin() && i < end());
+    for (iterator j = i + 1; j != end(); ++j)
+      *(j - 1) = *j;
+    entries[--count].~value_type();
+  }
+  size_type erase(const Key& key) {
+    iterator i = find(key);
+    if (i == end())
+      return 0;
+    erase(i);
+    return 1;
+  }
+};
+
+} // namespace ledger
+
+#endif // _FLATMAP_H
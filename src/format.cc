@@ -396,25 +396,40 @@ format_t::element_t * format_t::parse_elements(const string& fmt,
   return result.release();
 }
 
+namespace {
+  // The number of characters in UTF-8 text is the number of bytes which
+  // do not continue a multi-byte sequence
+  std::size_t utf8_length(const string& str, const std::size_t begin)
+  {
+    std::size_t len = 0;
+    for (string::size_type i = begin; i < str.length(); i++)
+      if ((static_cast<unsigned char>(str[i]) & 0xC0) != 0x80)
+        len++;
+    return len;
+  }
+}
+
 string format_t::real_calc(scope_t& scope)
 {
-  std::ostringstream out_str;
+  string result;
+  render(result, scope);
+  return result;
+}
 
+void format_t::render(string& buf, scope_t& scope)
+{
   for (element_t * elem = elements.get(); elem; elem = elem->next.get()) {
-    std::ostringstream out;
-    string name;
-
-    if (elem->has_flags(ELEMENT_ALIGN_LEFT))
-      out << std::left;
-    else
-      out << std::right;
+    const string::size_type start = buf.length();
 
     switch (elem->type) {
-    case element_t::STRING:
-      if (elem->min_width > 0)
-        out.width(static_cast<std::streamsize>(elem->min_width));
-      out << boost::get<string>(elem->data);
+    case element_t::STRING: {
+      const string& text(boost::get<string>(elem->data));
+      if (elem->min_width > text.length() &&
+          ! elem->has_flags(ELEMENT_ALIGN_LEFT))
+        buf.append(elem->min_width - text.length(), ' ');
+      buf += text;
       break;
+    }
 
     case element_t::EXPR: {
       expr_t& expr(boost::get<expr_t>(elem->data));
@@ -431,11 +446,20 @@ string format_t::real_calc(scope_t& scope)
         }
         DEBUG("format.expr", "value = (" << value << ")");
 
-        if (elem->min_width > 0)
-          value.print(out, static_cast<int>(elem->min_width), -1,
+        if (elem->min_width > 0) {
+          elem_out.str(empty_string);
+          elem_out.clear();
+          if (elem->has_flags(ELEMENT_ALIGN_LEFT))
+            elem_out << std::left;
+          else
+            elem_out << std::right;
+
+          value.print(elem_out, static_cast<int>(elem->min_width), -1,
                       ! elem->has_flags(ELEMENT_ALIGN_LEFT));
-        else
-          out << value.to_string();
+          buf += elem_out.str();
+        } else {
+          buf += value.to_string();
+        }
       }
       catch (const calc_error&) {
         string current_context = error_context();
@@ -452,24 +476,17 @@ string format_t::real_calc(scope_t& scope)
     }
 
     if (elem->max_width > 0 || elem->min_width > 0) {
-      unistring temp(out.str());
-      string    result;
+      std::size_t len = utf8_length(buf, start);
 
-      if (elem->max_width > 0 && elem->max_width < temp.length()) {
-        result = truncate(temp, elem->max_width);
-      } else {
-        result = temp.extract();
-        if (elem->min_width > temp.length())
-          for (std::size_t i = 0; i < elem->min_width - temp.length(); i++)
-            result += " ";
+      if (elem->max_width > 0 && elem->max_width < len) {
+        string text(truncate(unistring(string(buf, start)), elem->max_width));
+        buf.replace(start, string::npos, text);
+      }
+      else if (elem->min_width > len) {
+        buf.append(elem->min_width - len, ' ');
       }
-      out_str << result;
-    } else {
-      out_str << out.str();
     }
   }
-
-  return out_str.str();
 }
 
 string format_t::truncate(const unistring&  ustr,
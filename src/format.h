@@ -105,6 +105,11 @@ class format_t : public expr_base_t<string>, public noncopyable
 
   scoped_ptr<element_t> elements;
 
+  // Kept from one rendering to the next, so that a line of output does
+  // not construct a stream for each element or a string for itself
+  std::ostringstream elem_out;
+  string             line_buf;
+
 public:
   static enum elision_style_t {
     TRUNCATE_TRAILING,
@@ -150,6 +155,20 @@ public:
 
   virtual result_type real_calc(scope_t& scope);
 
+  /**
+   * Appends the text of this format for scope to buf.  The output
+   * handlers render each line through here into a reused buffer,
+   * rather than through calc(), which returns a new string each time.
+   */
+  void render(string& buf, scope_t& scope);
+  void render(std::ostream& out, scope_t& scope) {
+    if (! compiled)
+      compile(scope);
+    line_buf.clear();
+    render(line_buf, scope);
+    out << line_buf;
+  }
+
   virtual void dump(std::ostream& out) const {
     for (const element_t * elem = elements.get();
          elem;
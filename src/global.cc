@@ -170,7 +170,11 @@ char * global_scope_t::prompt_string()
 
 void global_scope_t::report_error(const std::exception& err)
 {
-  std::cout.flush();            // first display anything that was pending
+  // First display anything that was pending, including what the active
+  // report has buffered but not yet written
+  if (! report_stack.empty())
+    report().output_stream.flush();
+  std::cout.flush();
 
   if (caught_signal == NONE_CAUGHT) {
     // Display any pending error context information
@@ -295,7 +299,9 @@ void global_scope_t::report_options(report_t& report, std::ostream& out)
   HANDLER(args_only).report(out);
   HANDLER(debug_).report(out);
   HANDLER(init_file_).report(out);
+  HANDLER(jobs_).report(out);
   HANDLER(script_).report(out);
+  HANDLER(socket_).report(out);
   HANDLER(trace_).report(out);
   HANDLER(verbose).report(out);
   HANDLER(verify).report(out);
@@ -325,11 +331,15 @@ option_t<global_scope_t> * global_scope_t::lookup_option(const char * p)
   case 'i':
     OPT_(init_file_);
     break;
+  case 'j':
+    OPT(jobs_);
+    break;
   case 'o':
     OPT(options);
     break;
   case 's':
     OPT(script_);
+    else OPT(socket_);
     break;
   case 't':
     OPT(trace_);
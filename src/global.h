@@ -157,8 +157,15 @@ See LICENSE file included with the distribution for details and disclaimer.");
       on(none, _init_file);
    });
 
+  OPTION_(global_scope_t, jobs_, DO_(str) {
+      // Parsed as signed, so that a negative count is not taken as huge
+      if (lexical_cast<long>(str) < 1)
+        throw_(std::invalid_argument,
+               _f("The number of jobs must be at least 1: '%1%'") % str);
+    });
   OPTION(global_scope_t, options);
   OPTION(global_scope_t, script_);
+  OPTION(global_scope_t, socket_);
   OPTION(global_scope_t, trace_);
   OPTION(global_scope_t, verbose);
   OPTION(global_scope_t, verify);
@@ -91,6 +91,24 @@ public:
   PricePointMap pricemap;
   PriceRatioMap ratiomap;
 
+  // Every moment at which some edge has a price point, with the number of
+  // price points recorded at it.  Between two adjacent moments each edge
+  // selects the same price point, so a search gives the same answer for
+  // any reference time in that span.
+  typedef std::map<datetime_t, std::size_t> price_moments_map;
+
+  price_moments_map price_moments;
+
+  // The results of past searches, keyed by source, target (or NULL),
+  // the latest price moment at or before the reference time, and the
+  // oldest allowed price.  Cleared whenever a price is added or removed.
+  typedef tuple<const commodity_t *, const commodity_t *,
+                datetime_t, datetime_t> price_path_entry;
+  typedef std::map<price_path_entry,
+                   optional<price_point_t> > price_path_map;
+
+  price_path_map price_paths;
+
   commodity_history_impl_t()
     : pricemap(get(edge_price_point, price_graph)),
       ratiomap(get(edge_price_ratio, price_graph)) {}
@@ -110,6 +128,11 @@ public:
                   const datetime_t&  _oldest = datetime_t(),
                   bool bidirectionally = false);
 
+  void map_price_points(function<void(const commodity_t&, const datetime_t&,
+                                      const amount_t&)> fn);
+
+  optional<datetime_t> last_price_moment(const datetime_t& moment) const;
+
   optional<price_point_t>
   find_price(const commodity_t& source,
              const datetime_t&  moment,
@@ -122,6 +145,24 @@ public:
              const datetime_t&  oldest = datetime_t());
 
   void print_map(std::ostream& out, const datetime_t& moment = datetime_t());
+
+private:
+  optional<price_path_entry>
+  price_path_key(const commodity_t * source,
+                 const commodity_t * target,
+                 const datetime_t&   moment,
+                 const datetime_t&   oldest) const;
+
+  optional<price_point_t>
+  search_price(const commodity_t& source,
+               const datetime_t&  moment,
+               const datetime_t&  oldest);
+
+  optional<price_point_t>
+  search_price(const commodity_t& source,
+               const commodity_t& target,
+               const datetime_t&  moment,
+               const datetime_t&  oldest);
 };
 
 commodity_history_t::commodity_history_t()
@@ -162,6 +203,18 @@ void commodity_history_t::map_prices(
   p_impl->map_prices(fn, source, moment, _oldest, bidirectionally);
 }
 
+void commodity_history_t::map_price_points(
+  function<void(const commodity_t&, const datetime_t&, const amount_t&)> fn)
+{
+  p_impl->map_price_points(fn);
+}
+
+optional<datetime_t>
+commodity_history_t::last_price_moment(const datetime_t& moment) const
+{
+  return p_impl->last_price_moment(moment);
+}
+
 optional<price_point_t>
 commodity_history_t::find_price(const commodity_t& source,
                                 const datetime_t&  moment,
@@ -291,7 +344,11 @@ void commodity_history_impl_t::add_price(const commodity_t& source,
   if (! result.second) {
     // There is already an entry for this moment, so update it
     (*result.first).second = price;
+  } else {
+    price_moments[when]++;
   }
+
+  price_paths.clear();
 }
 
 void commodity_history_impl_t::remove_price(const commodity_t& source,
@@ -308,11 +365,18 @@ void commodity_history_impl_t::remove_price(const commodity_t& source,
     price_map_t& prices(get(ratiomap, e1.first));
 
     // jww (2012-03-04): If it fails, should we give a warning?
-    prices.erase(date);
+    if (prices.erase(date) > 0) {
+      price_moments_map::iterator i = price_moments.find(date);
+      assert(i != price_moments.end());
+      if (--(*i).second == 0)
+        price_moments.erase(i);
+    }
 
     if (prices.empty())
       remove_edge(e1.first, price_graph);
   }
+
+  price_paths.clear();
 }
 
 void commodity_history_impl_t::map_prices(
@@ -367,10 +431,109 @@ void commodity_history_impl_t::map_prices(
   }
 }
 
+void commodity_history_impl_t::map_price_points(
+  function<void(const commodity_t&, const datetime_t&, const amount_t&)> fn)
+{
+  // Every price point is visited in the order in which its edge was first
+  // created, so that replaying them through add_price() rebuilds the same
+  // graph.
+  NameMap namemap(get(vertex_name, price_graph));
+
+  graph_traits<Graph>::edge_iterator ei, ei_end;
+  for (boost::tuples::tie(ei, ei_end) = edges(price_graph);
+       ei != ei_end; ++ei) {
+    const commodity_t * u_comm = get(namemap, source(*ei, price_graph));
+    const commodity_t * v_comm = get(namemap, target(*ei, price_graph));
+
+    foreach (const price_map_t::value_type& pair, get(ratiomap, *ei)) {
+      const commodity_t& price_comm(pair.second.commodity());
+      fn(price_comm.graph_index() == u_comm->graph_index() ?
+         *v_comm : *u_comm, pair.first, pair.second);
+    }
+  }
+}
+
+optional<datetime_t>
+commodity_history_impl_t::last_price_moment(const datetime_t& moment) const
+{
+  price_moments_map::const_iterator i = price_moments.upper_bound(moment);
+  if (i == price_moments.begin())
+    return none;              // no edge has a price at or before moment
+  --i;
+  return (*i).first;
+}
+
+optional<commodity_history_impl_t::price_path_entry>
+commodity_history_impl_t::price_path_key(const commodity_t * source,
+                                         const commodity_t * target,
+                                         const datetime_t&   moment,
+                                         const datetime_t&   oldest) const
+{
+  optional<datetime_t> since = last_price_moment(moment);
+  if (! since)
+    return none;
+
+  // A missing oldest date is stored as negative infinity, since
+  // not_a_date_time does not order against other times.
+  return price_path_entry(source, target, *since,
+                          oldest.is_not_a_date_time() ?
+                          datetime_t(boost::posix_time::neg_infin) : oldest);
+}
+
 optional<price_point_t>
 commodity_history_impl_t::find_price(const commodity_t& source,
                                      const datetime_t&  moment,
                                      const datetime_t&  oldest)
+{
+  optional<price_path_entry> entry =
+    price_path_key(&source, NULL, moment, oldest);
+  if (! entry) {
+    DEBUG("history.find", "there are no prices before " << moment);
+    return none;
+  }
+
+  price_path_map::const_iterator i = price_paths.find(*entry);
+  if (i != price_paths.end()) {
+    DEBUG("history.find", "using remembered price for " << source.symbol());
+    return (*i).second;
+  }
+
+  optional<price_point_t> point = search_price(source, moment, oldest);
+  price_paths.insert(price_path_map::value_type(*entry, point));
+  return point;
+}
+
+optional<price_point_t>
+commodity_history_impl_t::find_price(const commodity_t& source,
+                                     const commodity_t& target,
+                                     const datetime_t&  moment,
+                                     const datetime_t&  oldest)
+{
+  assert(source != target);
+
+  optional<price_path_entry> entry =
+    price_path_key(&source, &target, moment, oldest);
+  if (! entry) {
+    DEBUG("history.find", "there are no prices before " << moment);
+    return none;
+  }
+
+  price_path_map::const_iterator i = price_paths.find(*entry);
+  if (i != price_paths.end()) {
+    DEBUG("history.find", "using remembered price for " << source.symbol()
+          << " in " << target.symbol());
+    return (*i).second;
+  }
+
+  optional<price_point_t> point = search_price(source, target, moment, oldest);
+  price_paths.insert(price_path_map::value_type(*entry, point));
+  return point;
+}
+
+optional<price_point_t>
+commodity_history_impl_t::search_price(const commodity_t& source,
+                                       const datetime_t&  moment,
+                                       const datetime_t&  oldest)
 {
   vertex_descriptor sv = vertex(*source.graph_index(), price_graph);
 
@@ -429,13 +592,11 @@ commodity_history_impl_t::find_price(const commodity_t& source,
 }
 
 optional<price_point_t>
-commodity_history_impl_t::find_price(const commodity_t& source,
-                                     const commodity_t& target,
-                                     const datetime_t&  moment,
-                                     const datetime_t&  oldest)
+commodity_history_impl_t::search_price(const commodity_t& source,
+                                       const commodity_t& target,
+                                       const datetime_t&  moment,
+                                       const datetime_t&  oldest)
 {
-  assert(source != target);
-
   vertex_descriptor sv = vertex(*source.graph_index(), price_graph);
   vertex_descriptor tv = vertex(*target.graph_index(), price_graph);
 
@@ -76,6 +76,12 @@ public:
                   const datetime_t&  _oldest = datetime_t(),
                   bool bidirectionally = false);
 
+  void map_price_points(function<void(const commodity_t&, const datetime_t&,
+                                      const amount_t&)> fn);
+
+  boost::optional<datetime_t>
+  last_price_moment(const datetime_t& moment) const;
+
   boost::optional<price_point_t>
   find_price(const commodity_t& source,
              const datetime_t&  moment,
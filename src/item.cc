@@ -420,12 +420,26 @@ void item_t::define(const symbol_t::kind_t, const string& name,
   set_tag(name, def->calc(bound_scope));
 }
 
+namespace {
+  symbol_cache_t item_functions;
+}
+
 expr_t::ptr_op_t item_t::lookup(const symbol_t::kind_t kind,
                                 const string& name)
 {
   if (kind != symbol_t::FUNCTION)
     return NULL;
 
+  expr_t::ptr_op_t def;
+  if (! item_functions.find(name, def)) {
+    def = lookup_function(name);
+    item_functions.remember(name, def);
+  }
+  return def;
+}
+
+expr_t::ptr_op_t item_t::lookup_function(const string& name)
+{
   switch (name[0]) {
   case 'a':
     if (name == "actual")
@@ -203,6 +203,7 @@ public:
                       expr_t::ptr_op_t);
   virtual expr_t::ptr_op_t lookup(const symbol_t::kind_t kind,
                                   const string& name);
+  expr_t::ptr_op_t lookup_function(const string& name);
 
   bool valid() const;
 };
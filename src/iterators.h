@@ -229,7 +229,9 @@ public:
     : iterator_facade_base<posts_commodities_iterator, post_t *,
                            boost::forward_traversal_tag>(i),
       journal_posts(i.journal_posts), xacts(i.xacts), posts(i.posts),
-      xact_temps(i.xact_temps), temps(i.temps) {
+      xact_temps(i.xact_temps) {
+    // The temporaries stay with the iterator that created them, which
+    // xact_temps refers to in either case
     TRACE_CTOR(posts_commodities_iterator, "copy");
   }
   ~posts_commodities_iterator() throw() {
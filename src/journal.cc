@@ -98,6 +98,8 @@ void journal_t::initialize()
   checking_style    = CHECK_NORMAL;
   recursive_aliases = false;
   no_aliases        = false;
+  parallel_includes = false;
+  cacheable         = true;
 }
 
 void journal_t::add_account(account_t * acct)
@@ -120,6 +122,11 @@ account_t * journal_t::find_account_re(const string& regexp)
   return master->find_account_re(regexp);
 }
 
+std::size_t journal_t::accounts_count() const
+{
+  return master->_next_id;
+}
+
 account_t * journal_t::register_account(const string& name, post_t * post,
                                         account_t * master_account)
 {
@@ -135,11 +142,9 @@ account_t * journal_t::register_account(const string& name, post_t * post,
   // If the account name being registered is "Unknown", check whether
   // the payee indicates an account that should be used.
   if (result->name == _("Unknown")) {
-    foreach (account_mapping_t& value, payees_for_unknown_accounts) {
-      if (post && value.first.match(post->xact->payee)) {
-        result = value.second;
-        break;
-      }
+    if (post) {
+      if (account_mapping_t * value = find_payee_account(post->xact->payee))
+        result = value->second;
     }
   }
 
@@ -249,16 +254,41 @@ string journal_t::register_payee(const string& name, xact_t * xact)
     }
   }
 
-  foreach (payee_alias_mapping_t& value, payee_alias_mappings) {
-    if (value.first.match(name)) {
-      payee = value.second;
-      break;
-    }
-  }
+  if (payee_alias_mapping_t * value = find_payee_alias(name))
+    payee = value->second;
 
   return payee.empty() ? name : payee;
 }
 
+namespace {
+  template <typename T>
+  T * find_first_mapping(std::vector<T>& mappings, mask_set_t& masks,
+                         const string& text)
+  {
+    // Mappings are only ever appended, so the masks of any new ones are
+    // added to the set before searching it.
+    if (masks.size() > mappings.size())
+      masks.clear();
+    for (std::size_t i = masks.size(); i < mappings.size(); i++)
+      masks.add(mappings[i].first);
+
+    if (optional<std::size_t> index = masks.find(text))
+      return &mappings[*index];
+    return NULL;
+  }
+}
+
+payee_alias_mapping_t * journal_t::find_payee_alias(const string& name)
+{
+  return find_first_mapping(payee_alias_mappings, payee_alias_masks, name);
+}
+
+account_mapping_t * journal_t::find_payee_account(const string& payee)
+{
+  return find_first_mapping(payees_for_unknown_accounts,
+                            payees_for_unknown_masks, payee);
+}
+
 void journal_t::register_commodity(commodity_t& comm,
                                    variant<int, xact_t *, post_t *> context)
 {
@@ -402,8 +432,7 @@ bool journal_t::add_xact(xact_t * xact)
   // applied to it.
   if (optional<value_t> ref = xact->get_tag(_("UUID"))) {
     std::string uuid = ref->to_string();
-    std::pair<checksum_map_t::iterator, bool> result
-      = checksum_map.insert(checksum_map_t::value_type(uuid, xact));
+    std::pair<xact_t *, bool> result = checksum_map.insert(uuid, xact);
     if (! result.second) {
       // This UUID has been seen before; apply any postings which the
       // earlier version may have deferred.
@@ -420,7 +449,7 @@ bool journal_t::add_xact(xact_t * xact)
         }
       }
 
-      xact_t * other = (*result.first).second;
+      xact_t * other = result.first;
 
       // Copy the two lists of postings (which should be relatively
       // short), and make sure that the intersection is the empty set
@@ -503,12 +532,13 @@ std::size_t journal_t::read(parse_context_stack_t& context)
       current.master = master;
 
     count = read_textual(context);
-    if (count > 0) {
-      if (! current.pathname.empty())
-        sources.push_back(fileinfo_t(current.pathname));
-      else
-        sources.push_back(fileinfo_t());
-    }
+    // Files that only hold directives or prices are still recorded, so
+    // that the journal cache notices when they change.
+    if (! current.pathname.empty() &&
+        (count > 0 || is_regular_file(current.pathname)))
+      sources.push_back(fileinfo_t(current.pathname));
+    else if (count > 0)
+      sources.push_back(fileinfo_t());
   }
   catch (...) {
     clear_xdata();
@@ -524,6 +554,24 @@ std::size_t journal_t::read(parse_context_stack_t& context)
   return count;
 }
 
+bool journal_t::sources_changed() const
+{
+  foreach (const fileinfo_t& info, sources) {
+    if (! info.filename)
+      continue;                 // streams cannot be read again
+
+    boost::system::error_code ec;
+    uintmax_t size    = file_size(*info.filename, ec);
+    std::time_t mtime = last_write_time(*info.filename, ec);
+    if (ec || size != info.size ||
+        posix_time::from_time_t(mtime) != info.modtime) {
+      DEBUG("journal.sources", "Source has changed: " << *info.filename);
+      return true;
+    }
+  }
+  return false;
+}
+
 bool journal_t::has_xdata()
 {
   foreach (xact_t * xact, xacts)
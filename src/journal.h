@@ -46,6 +46,7 @@
 #include "times.h"
 #include "mask.h"
 #include "expr.h"
+#include "checksum.h"
 
 namespace ledger {
 
@@ -58,17 +59,16 @@ class account_t;
 class parse_context_t;
 class parse_context_stack_t;
 
-typedef std::list<xact_t *>              xacts_list;
+typedef std::vector<xact_t *>            xacts_list;
 typedef std::list<auto_xact_t *>         auto_xacts_list;
 typedef std::list<period_xact_t *>       period_xacts_list;
 typedef std::pair<mask_t, string>        payee_alias_mapping_t;
-typedef std::list<payee_alias_mapping_t> payee_alias_mappings_t;
+typedef std::vector<payee_alias_mapping_t> payee_alias_mappings_t;
 typedef std::pair<string, string>        payee_uuid_mapping_t;
 typedef std::list<payee_uuid_mapping_t>  payee_uuid_mappings_t;
 typedef std::pair<mask_t, account_t *>   account_mapping_t;
-typedef std::list<account_mapping_t>     account_mappings_t;
+typedef std::vector<account_mapping_t>   account_mappings_t;
 typedef std::map<string, account_t *>    accounts_map;
-typedef std::map<string, xact_t *>       checksum_map_t;
 
 typedef std::multimap<string, expr_t::check_expr_pair> tag_check_exprs_map;
 
@@ -120,12 +120,16 @@ public:
   bool                   day_break;
   bool                   recursive_aliases;
   bool                   no_aliases;
+  bool                   parallel_includes;
+  bool                   cacheable;
   payee_alias_mappings_t payee_alias_mappings;
   payee_uuid_mappings_t  payee_uuid_mappings;
   account_mappings_t     account_mappings;
   accounts_map           account_aliases;
   account_mappings_t     payees_for_unknown_accounts;
-  checksum_map_t         checksum_map;
+  mask_set_t             payee_alias_masks;
+  mask_set_t             payees_for_unknown_masks;
+  checksum_index_t       checksum_map;
   tag_check_exprs_map    tag_check_exprs;
   optional<expr_t>       value_expr;
   parse_context_t *      current_context;
@@ -160,6 +164,14 @@ public:
 
   account_t * expand_aliases(string name);
 
+  // Account ids are handed out beneath the master account, so this is
+  // the size of a vector indexed by the ids of the journal's accounts.
+  // Temporary accounts are numbered past it and do not change it.
+  std::size_t accounts_count() const;
+
+  payee_alias_mapping_t * find_payee_alias(const string& name);
+  account_mapping_t *     find_payee_account(const string& payee);
+
   account_t * register_account(const string& name, post_t * post,
                                account_t * master = NULL);
   string      register_payee(const string& name, xact_t * xact);
@@ -193,6 +205,8 @@ public:
 
   std::size_t read(parse_context_stack_t& context);
 
+  bool sources_changed() const;
+
   bool has_xdata();
   void clear_xdata();
 
@@ -32,19 +32,29 @@
 #include <system.hh>
 
 #include "lookup.h"
-#include "unistring.h"
 
 namespace ledger {
 
 namespace {
-  typedef std::pair<xact_t *, int> score_entry_t;
-  typedef std::deque<score_entry_t> scorecard_t;
+  struct score_entry_t
+  {
+    int         score;
+    std::size_t order;
+    xact_t *    xact;
+
+    score_entry_t(int _score, std::size_t _order, xact_t * _xact)
+      : score(_score), order(_order), xact(_xact) {}
+  };
+
+  typedef std::vector<score_entry_t> scorecard_t;
   typedef std::map<uint32_t, std::size_t> char_positions_map;
 
+  // Higher scores first; among equal scores, the more recent xact.
   struct score_sorter {
     bool operator()(const score_entry_t& left,
                     const score_entry_t& right) const {
-      return left.second > right.second;
+      return (left.score > right.score ||
+              (left.score == right.score && left.order < right.order));
     }
   };
 
@@ -57,60 +67,28 @@ namespace {
       return left.second < right.second;
     }
   };
-}
 
-std::pair<xact_t *, account_t *>
-lookup_probable_account(const string& ident,
-                        xacts_list::reverse_iterator iter,
-                        xacts_list::reverse_iterator end,
-                        account_t * ref_account)
-{
-  scorecard_t scores;
+  // Only the best five payees are looked at for accounts, so no payee
+  // needs more than its five most recent xacts remembered.
+  const std::size_t max_candidates = 5;
 
-#if !HAVE_BOOST_REGEX_UNICODE
-    string lident = ident;
-    to_lower(lident);
-    unistring lowered_ident(lident);
-#else
-    // jww (2010-03-07): Not yet implemented
-    unistring lowered_ident(ident);
-#endif
-
-  DEBUG("lookup.account",
-        "Looking up identifier '" << lowered_ident.extract() << "'");
-#if DEBUG_ON
-  if (ref_account != NULL)
-    DEBUG("lookup.account",
-          "  with reference account: " << ref_account->fullname());
-#endif
-
-  xact_t * xact;
-  while (iter != end && (xact = *iter++) != NULL) {
-#if 0
-    // Only consider transactions from the last two years (jww (2010-03-07):
-    // make this an option)
-    if ((CURRENT_DATE() - xact->date()).days() > 700)
-      continue;
-#endif
-
-    // An exact match is worth a score of 100 and terminates the search
-    if (ident == xact->payee) {
-      DEBUG("lookup", "  we have an exact match, score = 100");
-      scores.push_back(score_entry_t(xact, 100));
-      break;
-    }
+  // Only payees scoring at least this much are considered
+  const int min_score = 30;
 
+  string lowered_payee(const string& payee)
+  {
 #if !HAVE_BOOST_REGEX_UNICODE
-    string payee = xact->payee;
-    to_lower(payee);
-    unistring value_key(payee);
+    string lowered = payee;
+    to_lower(lowered);
+    return lowered;
 #else
     // jww (2010-03-07): Not yet implemented
-    unistring value_key(xact->payee);
+    return payee;
 #endif
+  }
 
-    DEBUG("lookup", "Considering payee: " << value_key.extract());
-
+  int score_payee(const unistring& lowered_ident, const unistring& value_key)
+  {
     std::size_t        index          = 0;
     std::size_t        last_match_pos = unistring::npos;
     int                bonus          = 0;
@@ -230,9 +208,107 @@ lookup_probable_account(const string& ident,
       index++;
     }
 
-    // Only consider payees with a score of 30 or greater
-    if (score >= 30)
-      scores.push_back(score_entry_t(xact, score));
+    return score;
+  }
+}
+
+payee_index_t::payee_index_t(xacts_list::reverse_iterator iter,
+                             xacts_list::reverse_iterator end)
+{
+  TRACE_CTOR(payee_index_t, "xacts_list::reverse_iterator, "
+             "xacts_list::reverse_iterator");
+
+  std::map<string, std::size_t> lowered_payees;
+  std::size_t                   order = 0;
+
+  xact_t * xact;
+  while (iter != end && (xact = *iter++) != NULL) {
+    // Walking newest first, the first xact seen for a payee wins
+    exact_payees.insert(std::make_pair(xact->payee,
+                                       std::make_pair(order, xact)));
+
+    string lowered = lowered_payee(xact->payee);
+    std::map<string, std::size_t>::iterator i = lowered_payees.find(lowered);
+    if (i == lowered_payees.end()) {
+      i = lowered_payees.insert(std::make_pair(lowered,
+                                               entries.size())).first;
+      entries.emplace_back(lowered);
+    }
+
+    payee_entry_t& entry(entries[(*i).second]);
+    if (entry.recent.size() < max_candidates)
+      entry.recent.push_back(std::make_pair(order, xact));
+
+    order++;
+  }
+}
+
+std::pair<xact_t *, account_t *>
+payee_index_t::find(const string& ident, account_t * ref_account) const
+{
+  unistring lowered_ident(lowered_payee(ident));
+
+  DEBUG("lookup.account",
+        "Looking up identifier '" << lowered_ident.extract() << "'");
+#if DEBUG_ON
+  if (ref_account != NULL)
+    DEBUG("lookup.account",
+          "  with reference account: " << ref_account->fullname());
+#endif
+
+  // An exact match is worth a score of 100 and ends the search, so
+  // only xacts more recent than it are scored.
+  std::size_t exact_order = std::size_t(-1);
+  xact_t *    exact_xact  = NULL;
+
+  std::map<string, std::pair<std::size_t, xact_t *> >::const_iterator
+    exact = exact_payees.find(ident);
+  if (exact != exact_payees.end()) {
+    exact_order = (*exact).second.first;
+    exact_xact  = (*exact).second.second;
+  }
+
+  // The most each character of the identifier can add to a score if it
+  // does or does not appear in the payee.  Summing these gives an upper
+  // bound on score_payee, so payees that cannot reach the minimum score
+  // are never scored.
+  std::vector<int> present_gain, absent_gain;
+  for (std::size_t index = 0; index < lowered_ident.length(); index++) {
+    int divisor = int(index / 5) + 1;
+    int bonus   = index > 2 ? int(index) - 2 : 0;
+    present_gain.push_back(int(double(10 + bonus) / divisor));
+    absent_gain.push_back(int(double(-1) / divisor));
+  }
+
+  scorecard_t scores;
+
+  foreach (const payee_entry_t& entry, entries) {
+    if (entry.recent.front().first >= exact_order)
+      continue;
+
+    int bound = 0;
+    for (std::size_t index = 0; index < lowered_ident.length(); index++) {
+      boost::uint64_t bit =
+        boost::uint64_t(1) << (lowered_ident.utf32chars[index] & 63);
+      bound += (entry.chars & bit) ? present_gain[index] : absent_gain[index];
+    }
+    if (bound < min_score)
+      continue;
+
+    DEBUG("lookup", "Considering payee: " << entry.key.extract());
+
+    int score = score_payee(lowered_ident, entry.key);
+    if (score >= min_score) {
+      typedef std::pair<std::size_t, xact_t *> recent_pair;
+      foreach (const recent_pair& recent, entry.recent)
+        if (recent.first < exact_order)
+          scores.push_back(score_entry_t(score, recent.first, recent.second));
+    }
+  }
+
+  if (exact_xact) {
+    DEBUG("lookup", "  we have an exact match, score = 100");
+    scores.push_back(score_entry_t(100, exact_order, exact_xact));
   }
 
   // Sort the results by descending score, then look at every account ever
@@ -240,28 +316,30 @@ lookup_probable_account(const string& ident,
   // "decay" any latter accounts, so that we give recently used accounts a
   // slightly higher rating in case of a tie.
 
-  std::stable_sort(scores.begin(), scores.end(), score_sorter());
+  scorecard_t::iterator middle =
+    scores.begin() + std::min(scores.size(), max_candidates);
+  std::partial_sort(scores.begin(), middle, scores.end(), score_sorter());
 
   scorecard_t::iterator si        = scores.begin();
   int                   decay     = 0;
-  xact_t *              best_xact = si != scores.end() ? (*si).first : NULL;
+  xact_t *              best_xact = si != scores.end() ? (*si).xact : NULL;
   account_use_map       account_usage;
 
-  for (int i = 0; i < 5 && si != scores.end(); i++, si++) {
+  for (; si != middle; si++) {
     DEBUG("lookup.account",
-          "Payee: " << std::setw(5) << std::right << (*si).second <<
-          " - " << (*si).first->payee);
+          "Payee: " << std::setw(5) << std::right << (*si).score <<
+          " - " << (*si).xact->payee);
 
-    foreach (post_t * post, (*si).first->posts) {
+    foreach (post_t * post, (*si).xact->posts) {
       if (! post->has_flags(ITEM_TEMP | ITEM_GENERATED) &&
           post->account != ref_account &&
           ! post->account->has_flags(ACCOUNT_TEMP | ACCOUNT_GENERATED)) {
         account_use_map::iterator x = account_usage.find(post->account);
         if (x == account_usage.end())
           account_usage.insert(account_use_pair(post->account,
-                                                ((*si).second - decay)));
+                                                ((*si).score - decay)));
         else
-          (*x).second += ((*si).second - decay);
+          (*x).second += ((*si).score - decay);
       }
       decay++;
     }
@@ -284,4 +362,13 @@ lookup_probable_account(const string& ident,
   }
 }
 
+std::pair<xact_t *, account_t *>
+lookup_probable_account(const string& ident,
+                        xacts_list::reverse_iterator iter,
+                        xacts_list::reverse_iterator end,
+                        account_t * ref_account)
+{
+  return payee_index_t(iter, end).find(ident, ref_account);
+}
+
 } // namespace ledger
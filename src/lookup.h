@@ -43,9 +43,50 @@
 #define _LOOKUP_H
 
 #include "iterators.h"
+#include "unistring.h"
 
 namespace ledger {
 
+/**
+ * @brief An index of payees for guessing the account of a new xact
+ *
+ * The index is built once over a range of transactions, newest first,
+ * and can then be queried for any number of payees.  It returns the
+ * same result lookup_probable_account would for that range, but scores
+ * each distinct payee only once, and skips payees that cannot possibly
+ * reach the minimum score.
+ */
+class payee_index_t : public noncopyable
+{
+  struct payee_entry_t
+  {
+    unistring                                    key;
+    boost::uint64_t                              chars;
+    std::vector<std::pair<std::size_t, xact_t *> > recent;
+
+    explicit payee_entry_t(const string& lowered)
+      : key(lowered), chars(0) {
+      foreach (const boost::uint32_t& ch, key.utf32chars)
+        chars |= boost::uint64_t(1) << (ch & 63);
+    }
+  };
+
+  // Each entry holds the lowered payee, a bitmask of the characters it
+  // uses, and the positions of its newest few xacts.
+  std::deque<payee_entry_t>                      entries;
+  std::map<string, std::pair<std::size_t, xact_t *> > exact_payees;
+
+public:
+  payee_index_t(xacts_list::reverse_iterator iter,
+                xacts_list::reverse_iterator end);
+  ~payee_index_t() {
+    TRACE_DTOR(payee_index_t);
+  }
+
+  std::pair<xact_t *, account_t *>
+  find(const string& ident, account_t * ref_account = NULL) const;
+};
+
 std::pair<xact_t *, account_t *>
 lookup_probable_account(const string& ident,
                         xacts_list::reverse_iterator iter,
@@ -34,6 +34,7 @@
 #include "global.h"             // This is where the meat of main() is, which
                                 // was moved there for the sake of clarity here
 #include "session.h"
+#include "server.h"
 
 using namespace ledger;
 
@@ -106,16 +107,38 @@ int main(int argc, char * argv[], char * envp[])
       status = 0;
 
       ifstream in(global_scope->HANDLER(script_).str());
-      while (status == 0 && ! in.eof()) {
-        char line[1024];
-        in.getline(line, 1023);
-
-        char * p = skip_ws(line);
-        if (*p && *p != '#')
-          status =
-            global_scope->execute_command_wrapper(split_arguments(p), true);
+      if (global_scope->HANDLED(jobs_)) {
+        // Run the script's commands side by side against the journal
+        strings_list commands;
+        while (! in.eof()) {
+          char line[1024];
+          in.getline(line, 1023);
+
+          char * p = skip_ws(line);
+          if (*p && *p != '#')
+            commands.push_back(p);
+        }
+        status = run_commands(*global_scope, commands,
+                              static_cast<std::size_t>
+                              (lexical_cast<long>
+                               (global_scope->HANDLER(jobs_).str())));
+      } else {
+        while (status == 0 && ! in.eof()) {
+          char line[1024];
+          in.getline(line, 1023);
+
+          char * p = skip_ws(line);
+          if (*p && *p != '#')
+            status =
+              global_scope->execute_command_wrapper(split_arguments(p), true);
+        }
       }
     }
+    else if (global_scope->HANDLED(socket_) && args.empty()) {
+      // Ledger is serving commands to other processes over a socket
+      status = serve_commands(*global_scope,
+                              path(global_scope->HANDLER(socket_).str()));
+    }
     else if (! args.empty()) {
       // User has invoke a verb at the interactive command-line
       status = global_scope->execute_command_wrapper(args, false);
@@ -86,4 +86,252 @@ mask_t& mask_t::assign_glob(const string& pat)
   return (*this = re_pat);
 }
 
+string mask_set_t::required_literal(const string& pat)
+{
+  // Alternation, inline flags and quoting could each change what the
+  // literals in a pattern mean, so those patterns are not examined.
+  if (pat.find('|') != string::npos || pat.find("(?") != string::npos ||
+      pat.find("\\Q") != string::npos)
+    return empty_string;
+
+  string best;
+  string run;
+  int    depth = 0;
+
+  string::size_type len = pat.length();
+  for (string::size_type i = 0; i < len; i++) {
+    char c = pat[i];
+    bool literal = false;
+
+    switch (c) {
+    case '(':
+      depth++;
+      break;
+    case ')':
+      depth--;
+      break;
+
+    case '[':
+      // Skip the character class, including any [:name:] classes in it
+      if (i + 1 < len && pat[i + 1] == '^')
+        i++;
+      if (i + 1 < len && pat[i + 1] == ']')
+        i++;
+      for (i++; i < len && pat[i] != ']'; i++) {
+        if (pat[i] == '\\') {
+          i++;
+        }
+        else if (pat[i] == '[' && i + 1 < len &&
+                 (pat[i + 1] == ':' || pat[i + 1] == '=' ||
+                  pat[i + 1] == '.')) {
+          string::size_type end = pat.find(']', i + 2);
+          if (end == string::npos)
+            return best;
+          i = end;
+        }
+      }
+      break;
+
+    case '?':
+    case '*':
+    case '{':
+      // The preceding character may be absent or repeated
+      if (! run.empty())
+        run.erase(run.length() - 1);
+      if (c == '{') {
+        i = pat.find('}', i);
+        if (i == string::npos)
+          return best.length() < run.length() ? run : best;
+      }
+      break;
+
+    case '+':
+      // The preceding character occurs at least once, so it stays in
+      // the run, but anything after it may not follow it directly
+      break;
+
+    case '.':
+    case '^':
+    case '$':
+      break;
+
+    case '\\':
+      if (++i == len)
+        break;
+      c = pat[i];
+      if (std::isalnum(static_cast<unsigned char>(c))) {
+        switch (c) {
+        case 'L': case 'U': case 'l': case 'u': case 'E':
+          return empty_string;
+        case 'c':
+          i++;
+          break;
+        case 'x': case 'p': case 'P': case 'N': case 'g': case 'k':
+          if (i + 1 < len && pat[i + 1] == '{') {
+            i = pat.find('}', i);
+            if (i == string::npos)
+              return best.length() < run.length() ? run : best;
+          }
+          else if (c == 'x') {
+            while (i + 1 < len &&
+                   std::isxdigit(static_cast<unsigned char>(pat[i + 1])))
+              i++;
+          }
+          else {
+            i++;
+          }
+          break;
+        default:
+          while (i + 1 < len &&
+                 std::isdigit(static_cast<unsigned char>(pat[i + 1])))
+            i++;
+          break;
+        }
+      }
+      else if (std::strchr(".*+?()[]{}|^$\\/-# ", c)) {
+        literal = true;
+      }
+      break;
+
+    default:
+      literal = ! (c & 0x80);
+      break;
+    }
+
+    if (literal && depth == 0) {
+      run += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    else {
+      if (best.length() < run.length())
+        best = run;
+      run.clear();
+    }
+  }
+
+  return best.length() < run.length() ? run : best;
+}
+
+void mask_set_t::add(const mask_t& mask)
+{
+  string literal = required_literal(mask.str());
+
+  if (! literal.empty()) {
+    std::size_t state = 0;
+    foreach (char c, literal) {
+      std::map<char, std::size_t>::iterator i = nodes[state].next.find(c);
+      if (i != nodes[state].next.end()) {
+        state = (*i).second;
+      } else {
+        nodes.push_back(node_t());
+        nodes[state].next.insert(std::pair<char, std::size_t>
+                                 (c, nodes.size() - 1));
+        state = nodes.size() - 1;
+      }
+    }
+    nodes[state].outputs.push_back(masks.size());
+    linked = false;
+  }
+
+  DEBUG("mask.set", "Mask " << masks.size() << " /" << mask
+        << "/ requires \"" << literal << "\"");
+
+  masks.push_back(mask);
+  has_literal.push_back(! literal.empty());
+}
+
+void mask_set_t::clear()
+{
+  masks.clear();
+  has_literal.clear();
+  nodes.clear();
+  nodes.push_back(node_t());
+  linked = true;
+}
+
+void mask_set_t::link()
+{
+  // Compute the failure links breadth first, so that each node's
+  // shorter suffixes have been linked before it is
+  std::deque<std::size_t> queue;
+
+  typedef std::map<char, std::size_t>::value_type next_pair;
+  foreach (const next_pair& next, nodes[0].next) {
+    nodes[next.second].fail        = 0;
+    nodes[next.second].output_link = 0;
+    queue.push_back(next.second);
+  }
+
+  while (! queue.empty()) {
+    std::size_t state = queue.front();
+    queue.pop_front();
+
+    foreach (const next_pair& next, nodes[state].next) {
+      std::size_t fail = nodes[state].fail;
+      std::map<char, std::size_t>::iterator i;
+      while ((i = nodes[fail].next.find(next.first)) ==
+             nodes[fail].next.end() && fail != 0)
+        fail = nodes[fail].fail;
+
+      node_t& child(nodes[next.second]);
+      child.fail = i != nodes[fail].next.end() ? (*i).second : 0;
+      child.output_link = nodes[child.fail].outputs.empty() ?
+        nodes[child.fail].output_link : child.fail;
+
+      queue.push_back(next.second);
+    }
+  }
+
+  linked = true;
+}
+
+optional<std::size_t> mask_set_t::find(const string& text)
+{
+  if (masks.empty())
+    return none;
+
+  // Case folding beyond ASCII is left to the regular expressions, so
+  // the literals are only used to rule masks out for ASCII text.
+  bool ascii = true;
+  foreach (char c, text) {
+    if (c & 0x80) {
+      ascii = false;
+      break;
+    }
+  }
+
+  std::vector<bool> present;
+  if (ascii && nodes.size() > 1) {
+    if (! linked)
+      link();
+
+    present.resize(masks.size());
+
+    std::size_t state = 0;
+    foreach (char c, text) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+      std::map<char, std::size_t>::iterator i;
+      while ((i = nodes[state].next.find(c)) == nodes[state].next.end() &&
+             state != 0)
+        state = nodes[state].fail;
+      if (i != nodes[state].next.end())
+        state = (*i).second;
+
+      for (std::size_t out = (nodes[state].outputs.empty() ?
+                              nodes[state].output_link : state);
+           out != 0;
+           out = nodes[out].output_link)
+        foreach (std::size_t index, nodes[out].outputs)
+          present[index] = true;
+    }
+  }
+
+  for (std::size_t index = 0; index < masks.size(); index++)
+    if ((present.empty() || ! has_literal[index] || present[index]) &&
+        masks[index].match(text))
+      return index;
+
+  return none;
+}
+
 } // namespace ledger
@@ -126,6 +126,67 @@ public:
   }
 };
 
+/**
+ * @brief A list of masks searched together.
+ *
+ * find() returns the first mask, in the order they were added, which
+ * matches some text.  Rather than searching with each regular
+ * expression in turn, a run of literal characters that each pattern
+ * requires, if it has one, is entered into an Aho-Corasick automaton;
+ * one pass of it over the text rules out every mask whose literal does
+ * not occur, and only the rest are searched.
+ */
+class mask_set_t
+{
+  struct node_t {
+    std::map<char, std::size_t> next;
+    std::size_t                 fail;
+    std::size_t                 output_link;
+    std::vector<std::size_t>    outputs;
+
+    node_t() : fail(0), output_link(0) {}
+  };
+
+  std::vector<mask_t> masks;
+  std::vector<bool>   has_literal;
+  std::vector<node_t> nodes;
+  bool                linked;
+
+  void link();
+
+public:
+  mask_set_t() : nodes(1), linked(true) {
+    TRACE_CTOR(mask_set_t, "");
+  }
+  mask_set_t(const mask_set_t& other)
+    : masks(other.masks), has_literal(other.has_literal),
+      nodes(other.nodes), linked(other.linked) {
+    TRACE_CTOR(mask_set_t, "copy");
+  }
+  ~mask_set_t() throw() {
+    TRACE_DTOR(mask_set_t);
+  }
+
+  void add(const mask_t& mask);
+  void clear();
+
+  std::size_t size() const {
+    return masks.size();
+  }
+  bool empty() const {
+    return masks.empty();
+  }
+
+  optional<std::size_t> find(const string& text);
+
+  /**
+   * Returns the lowercased run of literal characters that any text
+   * matching `pattern' must contain, or an empty string if none can be
+   * determined.
+   */
+  static string required_literal(const string& pattern);
+};
+
 inline std::ostream& operator<<(std::ostream& out, const mask_t& mask) {
   out << mask.str();
   return out;
@@ -613,6 +613,305 @@ value_t expr_t::op_t::calc_seq(scope_t& scope, ptr_op_t * locus,
   return result;
 }
 
+shared_ptr<expr_t::program_t> expr_t::program_t::compile(const ptr_op_t& op)
+{
+  shared_ptr<program_t> program;
+
+  if (op->kind > op_t::TERMINALS) {
+    program.reset(new program_t);
+    program->lower(op, 0, 0);
+
+    // A program consisting of a single EVAL does nothing but forward
+    // to op_t::calc.
+    if (program->code.size() == 1 && program->code.front().opcode == EVAL)
+      program.reset();
+  }
+
+#if DEBUG_ON
+  if (program && SHOW_DEBUG("expr.program")) {
+    program->dump(*_log_stream);
+    DEBUG("expr.program", "");
+  }
+#endif
+
+  return program;
+}
+
+std::size_t expr_t::program_t::emit(opcode_t opcode, const std::size_t reg,
+                                    const std::size_t arg, const int depth,
+                                    const ptr_op_t& op)
+{
+  code.push_back(instr_t(opcode, reg, arg, depth, op));
+  return code.size() - 1;
+}
+
+void expr_t::program_t::lower(const ptr_op_t& op, const std::size_t reg,
+                              const int depth)
+{
+  if (registers.size() <= reg)
+    registers.resize(reg + 1);
+
+  switch (op->kind) {
+  case op_t::VALUE:
+    constants.push_back(op->as_value());
+    emit(LOAD, reg, constants.size() - 1, depth, op);
+    return;
+
+  case op_t::FUNCTION:
+    emit(CALL, reg, 0, depth + 1, op);
+    return;
+
+  case op_t::O_CALL:
+    // Only calls whose target was resolved to a function at compile
+    // time are dispatched directly; identifiers and lambdas still need
+    // find_definition at the point of use.
+    if (op->left()->is_function()) {
+      constants.push_back(op->has_right() ?
+                          split_cons_expr(op->right()) : value_t());
+      emit(CALL_ARGS, reg, constants.size() - 1, depth + 1, op);
+      return;
+    }
+    break;
+
+  case op_t::O_NOT:
+  case op_t::O_NEG:
+    lower(op->left(), reg, depth + 1);
+    emit(op->kind == op_t::O_NOT ? NOT : NEG, reg, 0, depth, op);
+    return;
+
+  case op_t::O_EQ:
+  case op_t::O_LT:
+  case op_t::O_LTE:
+  case op_t::O_GT:
+  case op_t::O_GTE:
+  case op_t::O_ADD:
+  case op_t::O_SUB:
+  case op_t::O_MUL:
+  case op_t::O_DIV:
+  case op_t::O_MATCH: {
+    opcode_t opcode;
+    switch (op->kind) {
+    case op_t::O_EQ:  opcode = EQ;    break;
+    case op_t::O_LT:  opcode = LT;    break;
+    case op_t::O_LTE: opcode = LTE;   break;
+    case op_t::O_GT:  opcode = GT;    break;
+    case op_t::O_GTE: opcode = GTE;   break;
+    case op_t::O_ADD: opcode = ADD;   break;
+    case op_t::O_SUB: opcode = SUB;   break;
+    case op_t::O_MUL: opcode = MUL;   break;
+    case op_t::O_DIV: opcode = DIV;   break;
+    default:          opcode = MATCH; break;
+    }
+    // Operands are evaluated in the same order as by op_t::calc, which
+    // for a match means the mask first.
+    if (opcode == MATCH) {
+      lower(op->right(), reg, depth + 1);
+      lower(op->left(), reg + 1, depth + 1);
+    } else {
+      lower(op->left(), reg, depth + 1);
+      lower(op->right(), reg + 1, depth + 1);
+    }
+    emit(opcode, reg, 0, depth, op);
+    return;
+  }
+
+  case op_t::O_AND: {
+    lower(op->left(), reg, depth + 1);
+    std::size_t if_false = emit(JUMP_UNLESS, reg, 0, depth, op);
+    lower(op->right(), reg, depth + 1);
+    std::size_t done = emit(JUMP, reg, 0, depth, op);
+    code[if_false].arg = emit(SET_FALSE, reg, 0, depth, op);
+    code[done].arg = code.size();
+    return;
+  }
+
+  case op_t::O_OR: {
+    lower(op->left(), reg, depth + 1);
+    std::size_t if_true = emit(JUMP_IF, reg, 0, depth, op);
+    lower(op->right(), reg, depth + 1);
+    code[if_true].arg = code.size();
+    return;
+  }
+
+  case op_t::O_QUERY: {
+    assert(op->right()->kind == op_t::O_COLON);
+    lower(op->left(), reg, depth + 1);
+    std::size_t if_false = emit(JUMP_UNLESS, reg, 0, depth, op);
+    lower(op->right()->left(), reg, depth + 1);
+    std::size_t done = emit(JUMP, reg, 0, depth, op);
+    code[if_false].arg = code.size();
+    lower(op->right()->right(), reg, depth + 1);
+    code[done].arg = code.size();
+    return;
+  }
+
+  default:
+    break;
+  }
+
+  emit(EVAL, reg, 0, depth, op);
+}
+
+value_t expr_t::program_t::run(scope_t& scope, ptr_op_t * locus)
+{
+  // A function called from this program may end up evaluating the same
+  // program again; the inner evaluation gets a register file of its own.
+  std::vector<value_t>  nested;
+  std::vector<value_t>& regs(running ? nested : registers);
+  if (running)
+    nested.resize(registers.size());
+
+  const bool      was_running = running;
+  const instr_t * pc          = &code.front();
+  const instr_t * end         = pc + code.size();
+
+  running = true;
+  try {
+    while (pc != end) {
+      value_t& result(regs[pc->reg]);
+
+      switch (pc->opcode) {
+      case LOAD:
+        result = constants[pc->arg];
+        break;
+
+      case CALL: {
+        call_scope_t call_args(scope, locus, pc->depth);
+        result = pc->op->as_function()(call_args);
+        check_type_context(scope, result);
+        break;
+      }
+
+      case CALL_ARGS: {
+        call_scope_t call_args(scope, locus, pc->depth);
+        call_args.set_args(constants[pc->arg]);
+        try {
+          result = pc->op->left()->as_function()(call_args);
+        }
+        catch (const std::exception&) {
+          add_error_context(_f("While calling function '%1% %2%':")
+                            % "<value expr>" % call_args.args);
+          throw;
+        }
+        check_type_context(scope, result);
+        break;
+      }
+
+      case EVAL:
+        result = pc->op->calc(scope, locus, pc->depth);
+        break;
+
+      case EQ:
+        result = result == regs[pc->reg + 1];
+        break;
+      case LT:
+        result = result < regs[pc->reg + 1];
+        break;
+      case LTE:
+        result = result <= regs[pc->reg + 1];
+        break;
+      case GT:
+        result = result > regs[pc->reg + 1];
+        break;
+      case GTE:
+        result = result >= regs[pc->reg + 1];
+        break;
+
+      case ADD:
+        result += regs[pc->reg + 1];
+        break;
+      case SUB:
+        result -= regs[pc->reg + 1];
+        break;
+      case MUL:
+        result *= regs[pc->reg + 1];
+        break;
+      case DIV:
+        result /= regs[pc->reg + 1];
+        break;
+
+      case MATCH:
+        result = result.as_mask().match(regs[pc->reg + 1].to_string());
+        break;
+
+      case NEG:
+        result.in_place_negate();
+        break;
+      case NOT:
+        result = ! result;
+        break;
+
+      case SET_FALSE:
+        result = false;
+        break;
+
+      case JUMP:
+        pc = &code.front() + pc->arg;
+        continue;
+      case JUMP_IF:
+        if (result) {
+          pc = &code.front() + pc->arg;
+          continue;
+        }
+        break;
+      case JUMP_UNLESS:
+        if (! result) {
+          pc = &code.front() + pc->arg;
+          continue;
+        }
+        break;
+      }
+      ++pc;
+    }
+  }
+  catch (const std::exception&) {
+    running = was_running;
+    if (locus && ! *locus)
+      *locus = pc->op;
+    foreach (value_t& reg, regs)
+      reg = NULL_VALUE;
+    throw;
+  }
+  running = was_running;
+
+  // Registers are cleared so that the values they held are not shared
+  // with the caller, who may want to modify the result in place.
+  value_t result = regs.front();
+  foreach (value_t& reg, regs)
+    reg = NULL_VALUE;
+  return result;
+}
+
+void expr_t::program_t::dump(std::ostream& out) const
+{
+  static const char * names[] = {
+    "LOAD", "CALL", "CALL_ARGS", "EVAL", "EQ", "LT", "LTE", "GT", "GTE",
+    "ADD", "SUB", "MUL", "DIV", "MATCH", "NEG", "NOT", "SET_FALSE",
+    "JUMP", "JUMP_IF", "JUMP_UNLESS"
+  };
+
+  std::size_t index = 0;
+  foreach (const instr_t& instr, code) {
+    out << std::right << std::setw(4) << index++ << "  "
+        << std::left << std::setw(12) << names[instr.opcode]
+        << " r" << instr.reg;
+    switch (instr.opcode) {
+    case LOAD:
+    case CALL_ARGS:
+      out << ", k" << instr.arg;
+      break;
+    case JUMP:
+    case JUMP_IF:
+    case JUMP_UNLESS:
+      out << ", @" << instr.arg;
+      break;
+    default:
+      break;
+    }
+    out << "  ; " << op_context(instr.op) << std::endl;
+  }
+}
+
 namespace {
   bool print_cons(std::ostream& out, const expr_t::const_ptr_op_t op,
                   const expr_t::op_t::context_t& context)
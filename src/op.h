@@ -316,6 +316,77 @@ private:
   value_t calc_seq(scope_t& scope, ptr_op_t * locus, const int depth);
 };
 
+/**
+ * @brief A compiled expression tree lowered into a flat instruction list.
+ *
+ * Arithmetic, comparisons, logical operators and calls to resolved
+ * functions are executed directly against a register file that is kept
+ * between evaluations; every other node is handed back to op_t::calc.
+ * The result, and the locus reported on error, are the same as those
+ * of the tree walker.
+ */
+class expr_t::program_t : public noncopyable
+{
+public:
+  enum opcode_t {
+    LOAD,                       // reg = constants[arg]
+    CALL,                       // reg = op's function, called without args
+    CALL_ARGS,                  // reg = op's function, called with constants[arg]
+    EVAL,                       // reg = op->calc()
+    EQ, LT, LTE, GT, GTE,       // reg = reg <op> reg + 1
+    ADD, SUB, MUL, DIV,
+    MATCH,                      // reg = mask reg matches reg + 1
+    NEG,                        // reg = -reg
+    NOT,                        // reg = ! reg
+    SET_FALSE,                  // reg = false
+    JUMP,                       // goto arg
+    JUMP_IF,                    // if (reg) goto arg
+    JUMP_UNLESS                 // if (! reg) goto arg
+  };
+
+  struct instr_t {
+    opcode_t    opcode;
+    std::size_t reg;
+    std::size_t arg;
+    int         depth;
+    ptr_op_t    op;             // reported as the locus on error
+
+    instr_t(opcode_t _opcode, std::size_t _reg, std::size_t _arg,
+            int _depth, ptr_op_t _op)
+      : opcode(_opcode), reg(_reg), arg(_arg), depth(_depth), op(_op) {}
+  };
+
+private:
+  std::vector<instr_t> code;
+  std::vector<value_t> constants;
+  std::vector<value_t> registers;
+  bool                 running;
+
+  program_t() : running(false) {
+    TRACE_CTOR(program_t, "");
+  }
+
+  void        lower(const ptr_op_t& op, const std::size_t reg, const int depth);
+  std::size_t emit(opcode_t opcode, const std::size_t reg,
+                   const std::size_t arg, const int depth,
+                   const ptr_op_t& op);
+
+public:
+  ~program_t() {
+    TRACE_DTOR(program_t);
+  }
+
+  /**
+   * Returns NULL if lowering @a op would gain nothing over calling its
+   * calc() directly, such as for a lone constant or function.
+   */
+  static shared_ptr<program_t> compile(const ptr_op_t& op);
+
+  value_t run(scope_t& scope, ptr_op_t * locus);
+
+  void dump(std::ostream& out) const;
+};
+
 inline expr_t::ptr_op_t
 expr_t::op_t::new_node(kind_t _kind, ptr_op_t _left, ptr_op_t _right)
 {
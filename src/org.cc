@@ -112,24 +112,27 @@ void posts_to_org_table::operator()(post_t& post)
       format_t group_title_format(report.HANDLER(group_title_format_).str());
 
       out << "|-|\n";
-      out << '|' << group_title_format(val_scope);
+      out << '|';
+      group_title_format.render(out, val_scope);
       out << "|-|\n";
 
       report_title = "";
     }
 
-    if (prepend_format)
-      out << '|' << prepend_format(bound_scope);
+    if (prepend_format) {
+      out << '|';
+      prepend_format.render(out, bound_scope);
+    }
 
     if (last_xact != post.xact) {
-      out << first_line_format(bound_scope);
+      first_line_format.render(out, bound_scope);
       last_xact = post.xact;
     }
     else if (last_post && last_post->date() != post.date()) {
-      out << first_line_format(bound_scope);
+      first_line_format.render(out, bound_scope);
     }
     else {
-      out << next_lines_format(bound_scope);
+      next_lines_format.render(out, bound_scope);
     }
 
     value_t amt = expr_t("display_amount").calc(bound_scope).simplified();
@@ -187,7 +190,7 @@ void posts_to_org_table::operator()(post_t& post)
 
           if (assigned) {
             amount_lines_format.mark_uncompiled();
-            out << amount_lines_format(call_scope);
+            amount_lines_format.render(out, call_scope);
           }
         }
       }
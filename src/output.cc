@@ -95,29 +95,29 @@ void format_posts::operator()(post_t& post)
       value_scope_t val_scope(bound_scope, string_value(report_title));
       format_t group_title_format(report.HANDLER(group_title_format_).str());
 
-      out << group_title_format(val_scope);
+      group_title_format.render(out, val_scope);
 
       report_title = "";
     }
 
     if (prepend_format) {
       out.width(static_cast<std::streamsize>(prepend_width));
-      out << prepend_format(bound_scope);
+      prepend_format.render(out, bound_scope);
     }
 
     if (last_xact != post.xact) {
       if (last_xact) {
         bind_scope_t xact_scope(report, *last_xact);
-        out << between_format(xact_scope);
+        between_format.render(out, xact_scope);
       }
-      out << first_line_format(bound_scope);
+      first_line_format.render(out, bound_scope);
       last_xact = post.xact;
     }
     else if (last_post && last_post->date() != post.date()) {
-      out << first_line_format(bound_scope);
+      first_line_format.render(out, bound_scope);
     }
     else {
-      out << next_lines_format(bound_scope);
+      next_lines_format.render(out, bound_scope);
     }
 
     post.xdata().add_flags(POST_EXT_DISPLAYED);
@@ -180,17 +180,17 @@ std::size_t format_accounts::post_account(account_t& account, const bool flat)
       value_scope_t val_scope(bound_scope, string_value(report_title));
       format_t group_title_format(report.HANDLER(group_title_format_).str());
 
-      out << group_title_format(val_scope);
+      group_title_format.render(out, val_scope);
 
       report_title = "";
     }
 
     if (prepend_format) {
       out.width(static_cast<std::streamsize>(prepend_width));
-      out << prepend_format(bound_scope);
+      prepend_format.render(out, bound_scope);
     }
 
-    out << account_line_format(bound_scope);
+    account_line_format.render(out, bound_scope);
 
     return 1;
   }
@@ -258,16 +258,16 @@ void format_accounts::flush()
   if (displayed > 1 &&
       ! report.HANDLED(no_total) && ! report.HANDLED(percent)) {
     bind_scope_t bound_scope(report, *report.session.journal->master);
-    out << separator_format(bound_scope);
+    separator_format.render(out, bound_scope);
 
     if (prepend_format) {
       static_cast<std::ostream&>(report.output_stream)
         .width(static_cast<std::streamsize>(prepend_width));
-      static_cast<std::ostream&>(report.output_stream)
-        << prepend_format(bound_scope);
+      prepend_format.render(static_cast<std::ostream&>(report.output_stream),
+                            bound_scope);
     }
 
-    out << total_line_format(bound_scope);
+    total_line_format.render(out, bound_scope);
   }
 
   out.flush();
@@ -45,7 +45,8 @@ shared_ptr<commodity_pool_t> commodity_pool_t::current_pool;
 commodity_pool_t::commodity_pool_t()
   : default_commodity(NULL), keep_base(false),
     quote_leeway(86400), get_quotes(false),
-    get_commodity_quote(commodity_quote_from_script)
+    get_commodity_quote(commodity_quote_from_script),
+    price_map_hits(0), price_map_misses(0), price_map_evictions(0)
 {
   null_commodity = create("");
   null_commodity->add_flags(COMMODITY_BUILTIN | COMMODITY_NOMARKET);
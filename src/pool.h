@@ -86,6 +86,12 @@ public:
            (commodity_t& commodity, const commodity_t * in_terms_of)>
       get_commodity_quote;
 
+  // Statistics on the commodities' remembered price lookups, which are
+  // reported under --debug commodity.price.find.
+  std::size_t price_map_hits;
+  std::size_t price_map_misses;
+  std::size_t price_map_evictions;
+
   static shared_ptr<commodity_pool_t> current_pool;
 
   explicit commodity_pool_t();
@@ -40,6 +40,30 @@
 
 namespace ledger {
 
+namespace {
+  // Every posting read from a journal is allocated here, so that they lie
+  // together in the order they were parsed rather than being scattered
+  // through the heap.
+  fixed_pool_t<sizeof(post_t)> post_pool;
+}
+
+void * post_t::operator new(std::size_t size)
+{
+  if (size != sizeof(post_t))
+    return ::operator new(size);
+  if (void * ptr = post_pool.allocate())
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void post_t::operator delete(void * ptr, std::size_t size)
+{
+  if (size != sizeof(post_t))
+    ::operator delete(ptr);
+  else
+    post_pool.deallocate(ptr);
+}
+
 bool post_t::has_tag(const string& tag, bool inherit) const
 {
   if (item_t::has_tag(tag))
@@ -406,6 +430,8 @@ namespace {
     }
     return true;
   }
+
+  symbol_cache_t post_functions;
 }
 
 expr_t::ptr_op_t post_t::lookup(const symbol_t::kind_t kind,
@@ -414,6 +440,16 @@ expr_t::ptr_op_t post_t::lookup(const symbol_t::kind_t kind,
   if (kind != symbol_t::FUNCTION)
     return item_t::lookup(kind, name);
 
+  expr_t::ptr_op_t def;
+  if (! post_functions.find(name, def)) {
+    def = lookup_function(name);
+    post_functions.remember(name, def);
+  }
+  return def;
+}
+
+expr_t::ptr_op_t post_t::lookup_function(const string& name)
+{
   switch (name[0]) {
   case 'a':
     if (name[1] == '\0' || name == "amount")
@@ -543,7 +579,7 @@ expr_t::ptr_op_t post_t::lookup(const symbol_t::kind_t kind,
     break;
   }
 
-  return item_t::lookup(kind, name);
+  return item_t::lookup(symbol_t::FUNCTION, name);
 }
 
 amount_t post_t::resolve_expr(scope_t& scope, expr_t& expr)
@@ -105,6 +105,14 @@ public:
     TRACE_DTOR(post_t);
   }
 
+  // Allocated from a pool of postings, see post.cc
+  static void * operator new(std::size_t size);
+  static void   operator delete(void * ptr, std::size_t size);
+  static void * operator new(std::size_t, void * place) {
+    return place;
+  }
+  static void   operator delete(void *, void *) {}
+
   virtual string description() {
     if (pos) {
       std::ostringstream buf;
@@ -140,6 +148,7 @@ public:
 
   virtual expr_t::ptr_op_t lookup(const symbol_t::kind_t kind,
                                   const string& name);
+  expr_t::ptr_op_t lookup_function(const string& name);
 
   amount_t resolve_expr(scope_t& scope, expr_t& expr);
 
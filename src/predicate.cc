@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <system.hh>
+
+#include "predicate.h"
+#include "op.h"
+#include "scope.h"
+#include "xact.h"
+#include "post.h"
+#include "account.h"
+
+namespace ledger {
+
+namespace {
+  typedef post_predicate_t::term_t term_t;
+
+  bool is_ident(expr_t::ptr_op_t op, const char * name) {
+    return op->kind == expr_t::op_t::IDENT && op->as_ident() == name;
+  }
+
+  bool is_mask(expr_t::ptr_op_t op) {
+    return op->kind == expr_t::op_t::VALUE && op->as_value().is_mask();
+  }
+
+  // The built-in functions of post_t and item_t that query terms refer
+  // to.  A post is always the innermost scope a post predicate is
+  // evaluated in, so these names can mean nothing else.
+  struct field_name_t {
+    const char *   name;
+    term_t::kind_t match;       // kind if used with =~, or EXPR
+    term_t::kind_t flag;        // kind if used by itself, or EXPR
+  };
+
+  const field_name_t field_names[] = {
+    { "account",   term_t::ACCOUNT_MATCH,   term_t::EXPR },
+    { "payee",     term_t::PAYEE_MATCH,     term_t::EXPR },
+    { "code",      term_t::CODE_MATCH,      term_t::EXPR },
+    { "note",      term_t::NOTE_MATCH,      term_t::EXPR },
+    { "commodity", term_t::COMMODITY_MATCH, term_t::EXPR },
+    { "cleared",   term_t::EXPR,            term_t::IS_CLEARED },
+    { "pending",   term_t::EXPR,            term_t::IS_PENDING },
+    { "uncleared", term_t::EXPR,            term_t::IS_UNCLEARED },
+    { "actual",    term_t::EXPR,            term_t::IS_ACTUAL },
+    { "real",      term_t::EXPR,            term_t::IS_REAL },
+    { "virtual",   term_t::EXPR,            term_t::IS_VIRTUAL },
+    { NULL,        term_t::EXPR,            term_t::EXPR }
+  };
+
+  const field_name_t * find_field(expr_t::ptr_op_t op) {
+    if (op->kind == expr_t::op_t::IDENT)
+      for (const field_name_t * field = field_names; field->name; field++)
+        if (op->as_ident() == field->name)
+          return field;
+    return NULL;
+  }
+
+  bool compare_kind(expr_t::op_t::kind_t kind, term_t::compare_t& compare) {
+    switch (kind) {
+    case expr_t::op_t::O_EQ:  compare = term_t::EQ;  return true;
+    case expr_t::op_t::O_LT:  compare = term_t::LT;  return true;
+    case expr_t::op_t::O_LTE: compare = term_t::LTE; return true;
+    case expr_t::op_t::O_GT:  compare = term_t::GT;  return true;
+    case expr_t::op_t::O_GTE: compare = term_t::GTE; return true;
+    default:
+      return false;
+    }
+  }
+
+  // These follow what value_t's comparison operators do for a field on
+  // the left and a constant on the right: x > y is y < x, x <= y is
+  // !(y < x) and x >= y is !(x < y).
+  bool compare_dates(term_t::compare_t compare, const date_t& field,
+                     const date_t& constant) {
+    switch (compare) {
+    case term_t::EQ:  return field == constant;
+    case term_t::LT:  return field < constant;
+    case term_t::LTE: return ! (constant < field);
+    case term_t::GT:  return constant < field;
+    case term_t::GTE: return ! (field < constant);
+    }
+    return false;
+  }
+
+  bool compare_amounts(term_t::compare_t compare, const amount_t& field,
+                       const long constant) {
+    switch (compare) {
+    case term_t::EQ:  return field == constant;
+    case term_t::LT:  return field < constant;
+    case term_t::LTE: return ! (field > constant);
+    case term_t::GT:  return field > constant;
+    case term_t::GTE: return ! (field < constant);
+    }
+    return false;
+  }
+}
+
+post_predicate_t::post_predicate_t(const predicate_t& _predicate)
+  : predicate(_predicate)
+{
+  if (expr_t::ptr_op_t op = predicate.get_op())
+    add_term(op);
+
+  TRACE_CTOR(post_predicate_t, "const predicate_t&");
+}
+
+std::size_t post_predicate_t::add_term(expr_t::ptr_op_t op)
+{
+  // Terms are stored children first, so that the root is the last one.
+  term_t term(term_t::EXPR, op);
+
+  switch (op->kind) {
+  case expr_t::op_t::IDENT:
+    if (const field_name_t * field = find_field(op))
+      term.kind = field->flag;
+    break;
+
+  case expr_t::op_t::O_MATCH:
+    if (const field_name_t * field = find_field(op->left())) {
+      if (field->match != term_t::EXPR && is_mask(op->right())) {
+        term.kind = field->match;
+        term.mask = op->right()->as_value().as_mask();
+        if (term.kind == term_t::ACCOUNT_MATCH)
+          term.mask_index = account_t::mask_index(*term.mask);
+      }
+    }
+    break;
+
+  case expr_t::op_t::O_CALL:
+    if (is_ident(op->left(), "has_tag") && op->has_right()) {
+      expr_t::ptr_op_t args = op->right();
+      if (is_mask(args)) {
+        term.kind = term_t::HAS_TAG;
+        term.mask = args->as_value().as_mask();
+      }
+      else if (args->kind == expr_t::op_t::O_CONS && is_mask(args->left()) &&
+               args->has_right() &&
+               args->right()->kind == expr_t::op_t::O_CONS &&
+               is_mask(args->right()->left()) &&
+               ! args->right()->has_right()) {
+        term.kind       = term_t::HAS_TAG;
+        term.mask       = args->left()->as_value().as_mask();
+        term.value_mask = args->right()->left()->as_value().as_mask();
+      }
+    }
+    break;
+
+  case expr_t::op_t::O_EQ:
+  case expr_t::op_t::O_LT:
+  case expr_t::op_t::O_LTE:
+  case expr_t::op_t::O_GT:
+  case expr_t::op_t::O_GTE:
+    if (op->right()->kind == expr_t::op_t::VALUE &&
+        compare_kind(op->kind, term.compare)) {
+      const value_t& constant(op->right()->as_value());
+      if (is_ident(op->left(), "date") && constant.is_date()) {
+        term.kind = term_t::DATE_COMPARE;
+        term.date = constant.as_date();
+      }
+      else if (is_ident(op->left(), "amount") && constant.is_long()) {
+        term.kind     = term_t::AMOUNT_COMPARE;
+        term.quantity = constant.as_long();
+      }
+    }
+    break;
+
+  case expr_t::op_t::O_NOT:
+    term.kind = term_t::NOT;
+    term.left = add_term(op->left());
+    break;
+
+  case expr_t::op_t::O_AND:
+  case expr_t::op_t::O_OR:
+    term.kind  = (op->kind == expr_t::op_t::O_AND ?
+                  term_t::AND : term_t::OR);
+    term.left  = add_term(op->left());
+    term.right = add_term(op->right());
+    break;
+
+  case expr_t::op_t::O_QUERY:
+    if (op->right()->kind == expr_t::op_t::O_COLON) {
+      term.kind  = term_t::QUERY;
+      term.left  = add_term(op->left());
+      term.right = add_term(op->right()->left());
+      term.third = add_term(op->right()->right());
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  terms.push_back(term);
+  return terms.size() - 1;
+}
+
+bool post_predicate_t::operator()(post_t& post, scope_t& context)
+{
+  if (terms.empty())
+    return true;
+
+  try {
+    value_t result(calc(terms.back(), post, context));
+    if (result.is_boolean())
+      return result.as_boolean();
+    else
+      return result.strip_annotations(predicate.what_to_keep).to_boolean();
+  }
+  catch (const std::exception&) {
+    // Evaluate the whole predicate again, so that the error is reported
+    // in the context of the full expression rather than one of its terms.
+    error_context();
+
+    bind_scope_t bound_scope(context, post);
+    return predicate(bound_scope).to_boolean();
+  }
+}
+
+value_t post_predicate_t::calc(term_t& term, post_t& post, scope_t& context)
+{
+  switch (term.kind) {
+  case term_t::EXPR:
+    break;
+
+  case term_t::ACCOUNT_MATCH:
+    return post.reported_account()->fullname_matches(*term.mask,
+                                                     term.mask_index);
+  case term_t::PAYEE_MATCH:
+    return term.mask->match(post.payee());
+  case term_t::CODE_MATCH:
+    return term.mask->match(post.xact->code ?
+                            *post.xact->code : empty_string);
+  case term_t::NOTE_MATCH:
+    return term.mask->match((post.note ? *post.note : empty_string) +
+                            (post.xact->note ? *post.xact->note :
+                             empty_string));
+  case term_t::COMMODITY_MATCH:
+    if (post.has_xdata() && post.xdata().has_flags(POST_EXT_COMPOUND))
+      break;
+    return term.mask->match(post.amount.commodity().symbol());
+
+  case term_t::HAS_TAG:
+    return post.has_tag(*term.mask, term.value_mask);
+
+  case term_t::IS_CLEARED:
+    return post.state() == item_t::CLEARED;
+  case term_t::IS_PENDING:
+    return post.state() == item_t::PENDING;
+  case term_t::IS_UNCLEARED:
+    return post.state() == item_t::UNCLEARED;
+  case term_t::IS_ACTUAL:
+    return ! post.has_flags(ITEM_GENERATED | ITEM_TEMP);
+  case term_t::IS_REAL:
+    return ! post.has_flags(POST_VIRTUAL);
+  case term_t::IS_VIRTUAL:
+    return post.has_flags(POST_VIRTUAL);
+
+  case term_t::DATE_COMPARE:
+    return compare_dates(term.compare, post.date(), term.date);
+
+  case term_t::AMOUNT_COMPARE:
+    // A null or compound amount has a different type as a value, and so
+    // compares differently; leave those to the expression.
+    if (post.amount.is_null() ||
+        (post.has_xdata() && post.xdata().has_flags(POST_EXT_COMPOUND)))
+      break;
+    return compare_amounts(term.compare, post.amount, term.quantity);
+
+  case term_t::NOT:
+    return ! calc(terms[term.left], post, context);
+
+  case term_t::AND:
+    if (calc(terms[term.left], post, context))
+      return calc(terms[term.right], post, context);
+    else
+      return false;
+
+  case term_t::OR:
+    if (value_t temp = calc(terms[term.left], post, context))
+      return temp;
+    else
+      return calc(terms[term.right], post, context);
+
+  case term_t::QUERY:
+    if (calc(terms[term.left], post, context))
+      return calc(terms[term.right], post, context);
+    else
+      return calc(terms[term.third], post, context);
+  }
+
+  bind_scope_t bound_scope(context, post);
+  return term.expr.calc(bound_scope);
+}
+
+void post_predicate_t::mark_uncompiled()
+{
+  predicate.mark_uncompiled();
+  foreach (term_t& term, terms)
+    term.expr.mark_uncompiled();
+}
+
+} // namespace ledger
@@ -92,6 +92,100 @@ public:
   }
 };
 
+class post_t;
+
+/**
+ * @brief A predicate_t that is tested directly against a post's fields.
+ *
+ * The terms that query_t writes -- account, payee, code, note and
+ * commodity matches, has_tag(), comparisons of date and amount against
+ * a constant, and the cleared/pending/actual/real flags -- are resolved
+ * without binding a scope or converting the field to a value_t.  Any
+ * other subexpression is evaluated as an ordinary expression, so the
+ * result is always the same as that of the predicate itself.
+ */
+class post_predicate_t
+{
+public:
+  struct term_t
+  {
+    enum kind_t {
+      EXPR,
+      ACCOUNT_MATCH,
+      PAYEE_MATCH,
+      CODE_MATCH,
+      NOTE_MATCH,
+      COMMODITY_MATCH,
+      HAS_TAG,
+      IS_CLEARED,
+      IS_PENDING,
+      IS_UNCLEARED,
+      IS_ACTUAL,
+      IS_REAL,
+      IS_VIRTUAL,
+      DATE_COMPARE,
+      AMOUNT_COMPARE,
+      NOT,
+      AND,
+      OR,
+      QUERY
+    };
+
+    enum compare_t { EQ, LT, LTE, GT, GTE };
+
+    kind_t           kind;
+    compare_t        compare;
+    std::size_t      left;
+    std::size_t      right;
+    std::size_t      third;
+    optional<mask_t> mask;
+    std::size_t      mask_index;
+    optional<mask_t> value_mask;
+    date_t           date;
+    long             quantity;
+    expr_t           expr;
+
+    term_t(kind_t _kind, expr_t::ptr_op_t op)
+      : kind(_kind), compare(EQ), left(0), right(0), third(0),
+        mask_index(0), quantity(0), expr(op) {
+      TRACE_CTOR(post_predicate_t::term_t, "kind_t, expr_t::ptr_op_t");
+    }
+    term_t(const term_t& other)
+      : kind(other.kind), compare(other.compare), left(other.left),
+        right(other.right), third(other.third), mask(other.mask),
+        mask_index(other.mask_index), value_mask(other.value_mask),
+        date(other.date),
+        quantity(other.quantity), expr(other.expr) {
+      TRACE_CTOR(post_predicate_t::term_t, "copy");
+    }
+    ~term_t() throw() {
+      TRACE_DTOR(post_predicate_t::term_t);
+    }
+  };
+
+  typedef std::vector<term_t> terms_vector;
+
+  predicate_t  predicate;
+  terms_vector terms;
+
+  post_predicate_t(const predicate_t& _predicate);
+  post_predicate_t(const post_predicate_t& other)
+    : predicate(other.predicate), terms(other.terms) {
+    TRACE_CTOR(post_predicate_t, "copy");
+  }
+  ~post_predicate_t() {
+    TRACE_DTOR(post_predicate_t);
+  }
+
+  bool operator()(post_t& post, scope_t& context);
+
+  void mark_uncompiled();
+
+private:
+  std::size_t add_term(expr_t::ptr_op_t op);
+  value_t     calc(term_t& term, post_t& post, scope_t& context);
+};
+
 } // namespace ledger
 
 #endif // _PREDICATE_H
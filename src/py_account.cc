@@ -204,14 +204,20 @@ void export_account()
                   make_getter(&account_t::parent,
                               return_internal_reference<>()))
 
-    .def_readwrite("name", &account_t::name)
+    .add_property("name",
+                  make_getter(&account_t::name,
+                              return_value_policy<return_by_value>()),
+                  &account_t::set_name)
     .def_readwrite("note", &account_t::note)
     .def_readonly("depth", &account_t::depth)
+    .def_readonly("id", &account_t::id)
 
-    .def("__str__", &account_t::fullname)
+    .def("__str__", &account_t::fullname,
+         return_value_policy<copy_const_reference>())
     .def("__unicode__", py_account_unicode)
 
-    .def("fullname", &account_t::fullname)
+    .def("fullname", &account_t::fullname,
+         return_value_policy<copy_const_reference>())
     .def("partial_name", &account_t::partial_name)
 
     .def("add_account", &account_t::add_account)
@@ -272,6 +272,7 @@ void export_journal()
                                   with_custodian_and_ward_postcall<1, 0> >()),
                   make_setter(&journal_t::bucket))
     .add_property("was_loaded", make_getter(&journal_t::was_loaded))
+    .add_property("accounts_count", &journal_t::accounts_count)
 
     .def("add_account", &journal_t::add_account)
     .def("remove_account", &journal_t::remove_account)
@@ -1287,6 +1287,7 @@ option_t<report_t> * report_t::lookup_option(const char * p)
     else OPT(unrealized_gains_);
     else OPT(unrealized_losses_);
     else OPT(unround);
+    else OPT(uuid_index_);
     break;
   case 'v':
     OPT_ALT(market, value);
@@ -352,6 +352,7 @@ public:
     HANDLER(unrealized_gains_).report(out);
     HANDLER(unrealized_losses_).report(out);
     HANDLER(unround).report(out);
+    HANDLER(uuid_index_).report(out);
     HANDLER(weekly).report(out);
     HANDLER(wide).report(out);
     HANDLER(yearly).report(out);
@@ -1035,6 +1036,8 @@ public:
       OTHER(total_).on(whence, "unrounded(total_expr)");
     });
 
+  OPTION(report_t, uuid_index_);
+
   OPTION_(report_t, weekly, DO() { // -W
       OTHER(period_).on(whence, "weekly");
     });
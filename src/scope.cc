@@ -38,6 +38,14 @@ namespace ledger {
 scope_t *       scope_t::default_scope = NULL;
 empty_scope_t * scope_t::empty_scope   = NULL;
 
+symbol_cache_t * symbol_cache_t::caches = NULL;
+
+void symbol_cache_t::clear_all()
+{
+  for (symbol_cache_t * cache = caches; cache; cache = cache->next)
+    cache->definitions.clear();
+}
+
 void symbol_scope_t::define(const symbol_t::kind_t kind,
                             const string& name, expr_t::ptr_op_t def)
 {
@@ -85,6 +85,47 @@ struct symbol_t
   }
 };
 
+/**
+ * @brief Remembers which built-in function a name resolves to.
+ *
+ * The functions exported by the lookup() methods of journal objects,
+ * such as posts and accounts, do not depend on the object they are
+ * looked up in.  Whatever a name resolves to for one object of a type
+ * -- including nothing at all -- therefore holds for all of them, and
+ * can be found with a single hash lookup the next time an expression
+ * is compiled against that type.
+ *
+ * Caches are meant to be static; clear_all() releases what they hold
+ * when the session is shut down.
+ */
+class symbol_cache_t : public noncopyable
+{
+  typedef boost::unordered_map<string, expr_t::ptr_op_t> definitions_map;
+
+  definitions_map   definitions;
+  symbol_cache_t *  next;
+
+  static symbol_cache_t * caches;
+
+public:
+  symbol_cache_t() : next(caches) {
+    caches = this;
+  }
+
+  bool find(const string& name, expr_t::ptr_op_t& def) const {
+    definitions_map::const_iterator i = definitions.find(name);
+    if (i == definitions.end())
+      return false;
+    def = (*i).second;
+    return true;
+  }
+  void remember(const string& name, expr_t::ptr_op_t def) {
+    definitions.insert(definitions_map::value_type(name, def));
+  }
+
+  static void clear_all();
+};
+
 class empty_scope_t;
 
 class scope_t
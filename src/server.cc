@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <system.hh>
+
+#include "server.h"
+#include "global.h"
+#include "session.h"
+#include "journal.h"
+
+namespace ledger {
+
+#if HAVE_UNIX_PIPES
+
+namespace {
+  int listen_on(const path& socket_path)
+  {
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    const string& name(socket_path.string());
+    if (name.length() >= sizeof(addr.sun_path))
+      throw_(std::runtime_error,
+             _f("Socket path is too long: %1%") % socket_path);
+    std::strcpy(addr.sun_path, name.c_str());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+      throw_(std::runtime_error, _("Failed to create socket"));
+
+    // A socket left behind by an earlier server would make bind fail.
+    ::unlink(name.c_str());
+
+    if (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr),
+               sizeof(addr)) == -1 || ::listen(fd, SOMAXCONN) == -1) {
+      ::close(fd);
+      throw_(std::runtime_error,
+             _f("Failed to listen on socket %1%") % socket_path);
+    }
+    return fd;
+  }
+
+  struct job_t
+  {
+    pid_t  pid;
+    int    fds[2];              // the command's stdout and stderr
+    string output[2];
+    int    status;              // the exit status, or -1 until reaped
+  };
+
+  job_t start_job(global_scope_t& global_scope, const string& command)
+  {
+    int out[2], err[2];
+    if (::pipe(out) == -1)
+      throw std::logic_error(_("Failed to create pipe"));
+    if (::pipe(err) == -1) {
+      ::close(out[0]);
+      ::close(out[1]);
+      throw std::logic_error(_("Failed to create pipe"));
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+
+    job_t job;
+    job.pid = ::fork();
+    if (job.pid == 0) {
+      ::dup2(out[1], STDOUT_FILENO);
+      ::dup2(err[1], STDERR_FILENO);
+      ::close(out[0]); ::close(out[1]);
+      ::close(err[0]); ::close(err[1]);
+
+      int status = global_scope.execute_command_wrapper
+        (split_arguments(command.c_str()), true);
+
+      std::cout.flush();
+      std::cerr.flush();
+      ::_exit(status);
+    }
+
+    ::close(out[1]);
+    ::close(err[1]);
+
+    if (job.pid < 0) {
+      ::close(out[0]);
+      ::close(err[0]);
+      throw std::logic_error(_("Failed to fork child process"));
+    }
+
+    job.fds[0] = out[0];
+    job.fds[1] = err[0];
+    job.status = -1;
+    return job;
+  }
+
+  void finish_job(job_t& job)
+  {
+    for (int i = 0; i < 2; i++)
+      if (job.fds[i] != -1) {
+        ::close(job.fds[i]);
+        job.fds[i] = -1;
+      }
+  }
+
+  int wait_for_job(job_t& job)
+  {
+    if (job.status == -1) {
+      int status;
+      if (::waitpid(job.pid, &status, 0) == -1 || ! WIFEXITED(status))
+        job.status = 1;
+      else
+        job.status = WEXITSTATUS(status);
+    }
+    return job.status;
+  }
+
+  string read_command_line(int fd)
+  {
+    string line;
+    char   ch;
+    while (::read(fd, &ch, 1) == 1 && ch != '\n')
+      line += ch;
+    if (! line.empty() && line[line.length() - 1] == '\r')
+      line.erase(line.length() - 1);
+    return line;
+  }
+
+  void run_command(global_scope_t& global_scope, int fd,
+                   const string& read_error)
+  {
+    string line = read_command_line(fd);
+
+    // Everything the command prints, including errors, goes back to the
+    // client.
+    ::dup2(fd, STDOUT_FILENO);
+    ::dup2(fd, STDERR_FILENO);
+    ::close(fd);
+
+    int status = 0;
+    if (! read_error.empty()) {
+      std::cerr << read_error;
+      status = 1;
+    } else {
+      char * p = skip_ws(const_cast<char *>(line.c_str()));
+      if (*p && *p != '#')
+        status =
+          global_scope.execute_command_wrapper(split_arguments(p), true);
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    ::_exit(status);
+  }
+}
+
+int serve_commands(global_scope_t& global_scope, const path& socket_path)
+{
+  session_t& session(global_scope.session());
+
+  foreach (const path& pathname, session.HANDLER(file_).data_files)
+    if (pathname == "-" || pathname == "/dev/stdin")
+      throw_(std::logic_error,
+             _("Cannot serve commands for a journal read from standard input"));
+
+  session.read_journal_files();
+
+  int listen_fd = listen_on(socket_path);
+
+  // Let an interrupt break out of accept(), rather than restarting it.
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  action.sa_handler = sigint_handler;
+  sigemptyset(&action.sa_mask);
+  ::sigaction(SIGINT, &action, NULL);
+  ::sigaction(SIGTERM, &action, NULL);
+
+  // The error from the last attempt to read the journal, if it failed,
+  // is given to every command until the journal reads cleanly.
+  string read_error;
+
+  while (caught_signal != INTERRUPTED) {
+    int fd = ::accept(listen_fd, NULL, NULL);
+
+    // Collect any commands which have finished by now.
+    while (::waitpid(-1, NULL, WNOHANG) > 0)
+      ;
+
+    if (fd == -1)
+      continue;
+
+    // Read the journal again if one of its files has changed since it was
+    // read, or if the last attempt to read it failed.
+    if (! read_error.empty() || session.journal->sources_changed()) {
+      DEBUG("server.reload", "Reading the journal again");
+      read_error.clear();
+      try {
+        session.close_journal_files();
+        session.read_journal_files();
+      }
+      catch (const std::exception& err) {
+        std::ostringstream buf;
+        string context = error_context();
+        if (! context.empty())
+          buf << context << std::endl;
+        buf << _("Error: ") << err.what() << std::endl;
+        read_error = buf.str();
+      }
+    }
+
+    // Anything left in the output buffers would otherwise be written by
+    // the child as well.
+    std::cout.flush();
+    std::cerr.flush();
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(listen_fd);
+      std::signal(SIGINT, SIG_DFL);
+      std::signal(SIGTERM, SIG_DFL);
+      run_command(global_scope, fd, read_error);
+    }
+    else if (pid < 0) {
+      std::cerr << _("Error: ") << _("Failed to fork child process")
+                << std::endl;
+    }
+    ::close(fd);
+  }
+
+  ::close(listen_fd);
+  ::unlink(socket_path.string().c_str());
+
+  while (::waitpid(-1, NULL, 0) > 0)
+    ;
+
+  caught_signal = NONE_CAUGHT;
+  return 0;
+}
+
+int run_commands(global_scope_t&     global_scope,
+                 const strings_list& commands,
+                 const std::size_t   jobs)
+{
+  std::deque<job_t>            running;
+  strings_list::const_iterator next   = commands.begin();
+  int                          status = 0;
+  bool                         failed = false;
+
+  while (status == 0 && (next != commands.end() || ! running.empty())) {
+    // Once any command is known to have failed, the commands after it
+    // will be abandoned, so none are started.
+    while (! failed && next != commands.end() &&
+           running.size() < std::max(jobs, std::size_t(1)))
+      running.push_back(start_job(global_scope, *next++));
+
+    // Write out every finished command at the head of the queue, so that
+    // output appears in the order the commands were given.
+    while (! running.empty() &&
+           running.front().fds[0] == -1 && running.front().fds[1] == -1) {
+      job_t& job(running.front());
+      status = wait_for_job(job);
+
+      std::cout << job.output[0];
+      std::cout.flush();
+      std::cerr << job.output[1];
+      std::cerr.flush();
+
+      running.pop_front();
+      if (status != 0)
+        break;
+    }
+
+    if (status != 0 || running.empty())
+      continue;
+
+    std::vector<struct pollfd> polls;
+    std::vector<std::pair<job_t *, int> > sources;
+    foreach (job_t& job, running) {
+      for (int i = 0; i < 2; i++) {
+        if (job.fds[i] != -1) {
+          struct pollfd entry;
+          entry.fd      = job.fds[i];
+          entry.events  = POLLIN;
+          entry.revents = 0;
+          polls.push_back(entry);
+          sources.push_back(std::make_pair(&job, i));
+        }
+      }
+    }
+
+    if (::poll(&polls[0], polls.size(), -1) == -1) {
+      if (errno == EINTR) {
+        check_for_signal();
+        continue;
+      }
+      throw std::logic_error(_("Failed to wait for command output"));
+    }
+
+    for (std::size_t i = 0; i < polls.size(); i++) {
+      if (! polls[i].revents)
+        continue;
+
+      job_t& job(*sources[i].first);
+      int    which = sources[i].second;
+
+      char    buf[8192];
+      ssize_t len = ::read(job.fds[which], buf, sizeof(buf));
+      if (len > 0) {
+        job.output[which].append(buf, static_cast<std::size_t>(len));
+      } else if (len == 0 || errno != EINTR) {
+        ::close(job.fds[which]);
+        job.fds[which] = -1;
+
+        // A command which has closed both its outputs has finished, so
+        // learn now whether it failed, even if it is not yet reported.
+        if (job.fds[0] == -1 && job.fds[1] == -1 && wait_for_job(job) != 0)
+          failed = true;
+      }
+    }
+  }
+
+  // A command failed, so abandon those already started after it.  They
+  // may have run in part, such as having begun writing an --output file.
+  foreach (job_t& job, running) {
+    finish_job(job);
+    if (job.status == -1)         // not yet reaped, so the pid is its own
+      ::kill(job.pid, SIGTERM);
+    wait_for_job(job);
+  }
+
+  return status;
+}
+
+#else // HAVE_UNIX_PIPES
+
+int serve_commands(global_scope_t&, const path&)
+{
+  throw_(std::logic_error,
+         _("Serving commands on a socket is not supported on this platform"));
+  return 1;
+}
+
+int run_commands(global_scope_t&     global_scope,
+                 const strings_list& commands,
+                 const std::size_t)
+{
+  int status = 0;
+  foreach (const string& command, commands) {
+    status = global_scope.execute_command_wrapper
+      (split_arguments(command.c_str()), true);
+    if (status != 0)
+      break;
+  }
+  return status;
+}
+
+#endif // HAVE_UNIX_PIPES
+
+} // namespace ledger
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2003-2017, John Wiegley.  All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * - Neither the name of New Artisans LLC nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @addtogroup report
+ */
+
+/**
+ * @file   server.h
+ * @author John Wiegley
+ *
+ * @ingroup report
+ *
+ * @brief Running report commands in child processes
+ *
+ * Once the journal has been read, any number of report commands can be
+ * run against it in forked child processes.  Each child shares the
+ * parent's journal until it writes to it, so several reports walk one
+ * parse at the same time, while the report data each one sets on the
+ * journal, along with every other piece of global state (the commodity
+ * pool, price memos, GMP temporaries), stays private to that child.
+ */
+#ifndef _SERVER_H
+#define _SERVER_H
+
+#include "utils.h"
+
+namespace ledger {
+
+class global_scope_t;
+
+/**
+ * Serve report commands on the Unix domain socket at socket_path, until
+ * interrupted.
+ *
+ * Each connection sends one command line, just as it would be typed at
+ * the REPL, and receives the command's output and any error messages,
+ * after which the connection is closed.  The journal is read once and
+ * kept in memory; before each command, it is read again only if one of
+ * the files it came from has changed since.  Commands are run in forked
+ * child processes, so the options and report data of one command never
+ * leak into the next.
+ *
+ * @return The exit status for the process.
+ */
+int serve_commands(global_scope_t& global_scope, const path& socket_path);
+
+/**
+ * Run each of commands, as with the REPL, using up to jobs child
+ * processes at once.  The output and error messages of each command are
+ * written out in the order the commands were given, exactly as if they
+ * had been run one after another.  As with a script, nothing after the
+ * first command that fails is reported.  No command is started once a
+ * failure is known, but those already started after the failing one are
+ * killed with SIGTERM and may have done part of their work.
+ *
+ * @return The exit status of the first command that failed, or zero.
+ */
+int run_commands(global_scope_t&     global_scope,
+                 const strings_list& commands,
+                 const std::size_t   jobs);
+
+} // namespace ledger
+
+#endif // _SERVER_H
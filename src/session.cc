@@ -35,6 +35,7 @@
 #include "xact.h"
 #include "account.h"
 #include "journal.h"
+#include "cache.h"
 #include "iterators.h"
 #include "filters.h"
 
@@ -52,6 +53,7 @@ void set_session_context(session_t * session)
     value_t::initialize();
   }
   else if (! session) {
+    symbol_cache_t::clear_all();
     value_t::shutdown();
     amount_t::shutdown();
     times_shutdown();
@@ -113,6 +115,9 @@ std::size_t session_t::read_data(const string& master_account)
   if (HANDLED(no_aliases))
     journal->no_aliases = true;
 
+  if (HANDLED(parallel_includes))
+    journal->parallel_includes = true;
+
   if (HANDLED(explicit))
     journal->force_checking = true;
   if (HANDLED(check_payees))
@@ -128,6 +133,49 @@ std::size_t session_t::read_data(const string& master_account)
   if (HANDLED(value_expr_))
     journal->value_expr = HANDLER(value_expr_).str();
 
+  // The cache is not used when the journal comes from standard input, or
+  // when parsing would produce warnings or depend on an expression.
+  unique_ptr<journal_cache_t> cache;
+  if (HANDLED(cache_) && journal->xacts.empty() && ! HANDLED(explicit) &&
+      ! HANDLED(check_payees) && ! HANDLED(strict) && ! HANDLED(pedantic) &&
+      ! HANDLED(value_expr_) &&
+      std::find_if(HANDLER(file_).data_files.begin(),
+                   HANDLER(file_).data_files.end(),
+                   [](const path& pathname) {
+                     return pathname == "-" || pathname == "/dev/stdin";
+                   }) == HANDLER(file_).data_files.end()) {
+    // Everything besides the source files themselves that changes the
+    // result of parsing goes into the key.
+    std::ostringstream key;
+    key << Ledger_VERSION_MAJOR << '.' << Ledger_VERSION_MINOR << '.'
+        << Ledger_VERSION_PATCH << Ledger_VERSION_PRERELEASE << '\n';
+    foreach (const path& pathname, HANDLER(file_).data_files)
+      key << filesystem::absolute(resolve_path(pathname)).string() << '\n';
+    // A price database that exists is recorded among the sources, so
+    // only whether it exists needs to be part of the key; otherwise one
+    // created after the cache was written would be ignored.
+    if (price_db_path)
+      key << price_db_path->string()
+          << (exists(*price_db_path) ? "" : " (missing)");
+    key << '\n' << master_account << '\n';
+    if (HANDLED(input_date_format_))
+      key << HANDLER(input_date_format_).str();
+    key << '\n'
+        << HANDLED(decimal_comma) << HANDLED(time_colon) << HANDLED(day_break)
+        << HANDLED(recursive_aliases) << HANDLED(no_aliases)
+        << HANDLED(permissive) << '\n'
+        // Dates without a year are read relative to today.
+        << CURRENT_DATE().year() << '/' << CURRENT_DATE().month() << '\n';
+
+    cache.reset(new journal_cache_t(resolve_path(HANDLER(cache_).str()),
+                                    key.str()));
+    if (cache->load(*journal)) {
+      if (populated_data_files)
+        HANDLER(file_).data_files.clear();
+      return journal->xacts.size();
+    }
+  }
+
   if (price_db_path) {
     if (exists(*price_db_path)) {
       parsing_context.push(*price_db_path);
@@ -181,6 +229,9 @@ std::size_t session_t::read_data(const string& master_account)
         << "] == journal->xacts.size() [" << journal->xacts.size() << "]");
   assert(xact_count == journal->xacts.size());
 
+  if (cache)
+    cache->save(*journal);
+
   if (populated_data_files)
     HANDLER(file_).data_files.clear();
 
@@ -317,7 +368,8 @@ option_t<session_t> * session_t::lookup_option(const char * p)
     OPT_CH(price_exp_);
     break;
   case 'c':
-    OPT(check_payees);
+    OPT(cache_);
+    else OPT(check_payees);
     break;
   case 'd':
     OPT(download); // -Q
@@ -347,6 +399,7 @@ option_t<session_t> * session_t::lookup_option(const char * p)
     else OPT(price_exp_);
     else OPT(pedantic);
     else OPT(permissive);
+    else OPT(parallel_includes);
     break;
   case 'r':
     OPT(recursive_aliases);
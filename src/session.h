@@ -97,6 +97,7 @@ public:
 
   void report_options(std::ostream& out)
   {
+    HANDLER(cache_).report(out);
     HANDLER(check_payees).report(out);
     HANDLER(day_break).report(out);
     HANDLER(download).report(out);
@@ -112,6 +113,7 @@ public:
     HANDLER(price_exp_).report(out);
     HANDLER(recursive_aliases).report(out);
     HANDLER(no_aliases).report(out);
+    HANDLER(parallel_includes).report(out);
     HANDLER(strict).report(out);
     HANDLER(value_expr_).report(out);
   }
@@ -125,6 +127,7 @@ public:
    * Option handlers
    */
 
+  OPTION(session_t, cache_);
   OPTION(session_t, check_payees);
   OPTION(session_t, day_break);
   OPTION(session_t, download); // -Q
@@ -168,6 +171,7 @@ public:
   OPTION(session_t, value_expr_);
   OPTION(session_t, recursive_aliases);
   OPTION(session_t, no_aliases);
+  OPTION(session_t, parallel_includes);
 };
 
 /**
@@ -35,6 +35,63 @@
 
 namespace ledger {
 
+bool fd_ostream_t::buf_t::write_all(const char * data, std::size_t len)
+{
+  while (len > 0) {
+    ssize_t written = ::write(fd, data, len);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    len  -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+bool fd_ostream_t::buf_t::drain()
+{
+  std::size_t len = static_cast<std::size_t>(pptr() - pbase());
+  setp(buffer, buffer + sizeof(buffer));
+  return len == 0 || write_all(buffer, len);
+}
+
+fd_ostream_t::buf_t::int_type fd_ostream_t::buf_t::overflow(int_type ch)
+{
+  if (! drain())
+    return traits_type::eof();
+  if (! traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+std::streamsize fd_ostream_t::buf_t::xsputn(const char * s, std::streamsize n)
+{
+  // Small pieces are copied into the buffer; anything that would not
+  // fit goes to the descriptor directly once the buffer is drained.
+  if (n <= epptr() - pptr()) {
+    std::memcpy(pptr(), s, static_cast<std::size_t>(n));
+    pbump(static_cast<int>(n));
+    return n;
+  }
+  if (! drain())
+    return 0;
+  if (n < static_cast<std::streamsize>(sizeof(buffer))) {
+    std::memcpy(pptr(), s, static_cast<std::size_t>(n));
+    pbump(static_cast<int>(n));
+    return n;
+  }
+  return write_all(s, static_cast<std::size_t>(n)) ? n : 0;
+}
+
+int fd_ostream_t::buf_t::sync()
+{
+  return drain() ? 0 : -1;
+}
+
 namespace {
   /**
    * @brief Forks a child process so that Ledger may handle running a
@@ -88,12 +145,7 @@ namespace {
     }
     else {                      // parent
       close(pfd[0]);
-      typedef iostreams::stream<iostreams::file_descriptor_sink> fdstream;
-#if BOOST_VERSION >= 104400
-      *os = new fdstream(pfd[1], iostreams::never_close_handle);
-#else // BOOST_VERSION >= 104400
-      *os = new fdstream(pfd[1]);
-#endif // BOOST_VERSION >= 104400
+      *os = new fd_ostream_t(pfd[1]);
     }
     return pfd[1];
 #else
@@ -109,6 +161,15 @@ void output_stream_t::initialize(const optional<path>& output_file,
     os = new ofstream(*output_file);
   else if (pager_path)
     pipe_to_pager_fd = do_fork(&os, *pager_path);
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+  else if (! isatty(STDOUT_FILENO)) {
+    // When stdout is a pipe or a file nobody watches it line by line, so
+    // batch the report into large writes.  Anything already queued on
+    // std::cout must go out first to keep the output in order.
+    std::cout.flush();
+    os = new fd_ostream_t(STDOUT_FILENO);
+  }
+#endif
   else
     os = &std::cout;
 }
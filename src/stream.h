@@ -52,6 +52,48 @@
 
 namespace ledger {
 
+/**
+ * @brief A buffered stream writing straight to a file descriptor
+ *
+ * Reports are produced as many small insertions.  Rather than handing
+ * each of those to stdio or a pipe, fd_ostream_t collects them in one
+ * large buffer and passes it to write(2) only when the buffer fills or
+ * the stream is explicitly flushed.  The descriptor is never closed.
+ */
+class fd_ostream_t : public std::ostream
+{
+  class buf_t : public std::streambuf
+  {
+    int   fd;
+    char  buffer[65536];
+
+  public:
+    explicit buf_t(int _fd) : fd(_fd) {
+      setp(buffer, buffer + sizeof(buffer));
+    }
+
+  protected:
+    virtual int_type overflow(int_type ch);
+    virtual std::streamsize xsputn(const char * s, std::streamsize n);
+    virtual int sync();
+
+  private:
+    bool write_all(const char * data, std::size_t len);
+    bool drain();
+  };
+
+  buf_t buf;
+
+public:
+  explicit fd_ostream_t(int fd) : std::ostream(&buf), buf(fd) {
+    TRACE_CTOR(fd_ostream_t, "int");
+  }
+  ~fd_ostream_t() {
+    TRACE_DTOR(fd_ostream_t);
+    flush();
+  }
+};
+
 /**
  * @brief An output stream
  *
@@ -125,7 +167,9 @@ public:
   }
 
   /**
-   * Flushing function.  A simple proxy for ostream's flush.
+   * Flushing function.  A simple proxy for ostream's flush.  Reports
+   * call this once they are complete, which is the point at which
+   * buffered output actually reaches its destination.
    */
   void flush() {
     os->flush();
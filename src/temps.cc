@@ -38,109 +38,132 @@
 
 namespace ledger {
 
-xact_t& temporaries_t::copy_xact(xact_t& origin)
+temporaries_t::~temporaries_t()
 {
-  if (! xact_temps)
-    xact_temps = std::list<xact_t>();
+  TRACE_DTOR(temporaries_t);
+  clear();
+
+  foreach (char * block, blocks)
+    checked_array_delete(block);
+}
 
-  xact_temps->push_back(origin);
-  xact_t& temp(xact_temps->back());
+void * temporaries_t::allocate(std::size_t size, std::size_t alignment)
+{
+  assert(size <= BLOCK_SIZE);
+
+  std::size_t offset = (block_used + alignment - 1) & ~(alignment - 1);
+  if (blocks.empty() || offset + size > BLOCK_SIZE) {
+    if (! blocks.empty())
+      block_index++;
+    if (block_index == blocks.size())
+      blocks.push_back(new char[BLOCK_SIZE]);
+    offset = 0;
+  }
+  block_used = offset + size;
 
-  temp.add_flags(ITEM_TEMP);
-  return temp;
+  return blocks[block_index] + offset;
 }
 
-xact_t& temporaries_t::create_xact()
+xact_t& temporaries_t::copy_xact(xact_t& origin)
 {
-  if (! xact_temps)
-    xact_temps = std::list<xact_t>();
+  xact_t * temp = new (allocate<xact_t>()) xact_t(origin);
+  xact_temps.push_back(temp);
+
+  temp->add_flags(ITEM_TEMP);
+  return *temp;
+}
 
-  xact_temps->push_back(xact_t());
-  xact_t& temp(xact_temps->back());
+xact_t& temporaries_t::create_xact()
+{
+  xact_t * temp = new (allocate<xact_t>()) xact_t;
+  xact_temps.push_back(temp);
 
-  temp.add_flags(ITEM_TEMP);
-  return temp;
+  temp->add_flags(ITEM_TEMP);
+  return *temp;
 }
 
 post_t& temporaries_t::copy_post(post_t& origin, xact_t& xact,
                                  account_t * account)
 {
-  if (! post_temps)
-    post_temps = std::list<post_t>();
-
-  post_temps->push_back(origin);
-  post_t& temp(post_temps->back());
+  post_t * temp = new (allocate<post_t>()) post_t(origin);
+  post_temps.push_back(temp);
 
-  temp.add_flags(ITEM_TEMP);
+  temp->add_flags(ITEM_TEMP);
   if (account)
-    temp.account = account;
+    temp->account = account;
 
-  temp.account->add_post(&temp);
-  xact.add_post(&temp);
+  temp->account->add_post(temp);
+  xact.add_post(temp);
 
-  return temp;
+  return *temp;
 }
 
 post_t& temporaries_t::create_post(xact_t& xact, account_t * account,
                                    bool bidir_link)
 {
-  if (! post_temps)
-    post_temps = std::list<post_t>();
+  post_t * temp = new (allocate<post_t>()) post_t(account);
+  post_temps.push_back(temp);
 
-  post_temps->push_back(post_t(account));
-  post_t& temp(post_temps->back());
+  temp->add_flags(ITEM_TEMP);
+  temp->account = account;
 
-  temp.add_flags(ITEM_TEMP);
-  temp.account = account;
-
-  temp.account->add_post(&temp);
+  temp->account->add_post(temp);
   if (bidir_link)
-    xact.add_post(&temp);
+    xact.add_post(temp);
   else
-    temp.xact = &xact;
+    temp->xact = &xact;
 
-  return temp;
+  return *temp;
 }
 
 account_t& temporaries_t::create_account(const string& name,
                                          account_t *   parent)
 {
-  if (! acct_temps)
-    acct_temps = std::list<account_t>();
-
-  acct_temps->push_back(account_t(parent, name));
-  account_t& temp(acct_temps->back());
-
-  temp.add_flags(ACCOUNT_TEMP);
-  if (parent)
-    parent->add_account(&temp);
+  account_t * temp = new (allocate<account_t>()) account_t(parent, name);
+  acct_temps.push_back(temp);
+
+  temp->add_flags(ACCOUNT_TEMP);
+  if (parent) {
+    // Give back the id just taken from the tree, so that temporaries do
+    // not use up ids across reports
+    account_t * root = parent->root();
+    --root->_next_id;
+    temp->id = root->_next_id + acct_ids++;
+
+    parent->add_account(temp);
+  }
 
-  return temp;
+  return *temp;
 }
 
 void temporaries_t::clear()
 {
-  if (post_temps) {
-    foreach (post_t& post, *post_temps) {
-      if (! post.xact->has_flags(ITEM_TEMP))
-        post.xact->remove_post(&post);
-
-      if (post.account && ! post.account->has_flags(ACCOUNT_TEMP))
-        post.account->remove_post(&post);
-    }
-    post_temps->clear();
+  foreach (post_t * post, post_temps) {
+    if (! post->xact->has_flags(ITEM_TEMP))
+      post->xact->remove_post(post);
+
+    if (post->account && ! post->account->has_flags(ACCOUNT_TEMP))
+      post->account->remove_post(post);
   }
+  foreach (post_t * post, post_temps)
+    post->~post_t();
+  post_temps.clear();
 
-  if (xact_temps)
-    xact_temps->clear();
+  foreach (xact_t * xact, xact_temps)
+    xact->~xact_t();
+  xact_temps.clear();
 
-  if (acct_temps) {
-    foreach (account_t& acct, *acct_temps) {
-      if (acct.parent && ! acct.parent->has_flags(ACCOUNT_TEMP))
-        acct.parent->remove_account(&acct);
-    }
-    acct_temps->clear();
+  foreach (account_t * acct, acct_temps) {
+    if (acct->parent && ! acct->parent->has_flags(ACCOUNT_TEMP))
+      acct->parent->remove_account(acct);
   }
+  foreach (account_t * acct, acct_temps)
+    acct->~account_t();
+  acct_temps.clear();
+  acct_ids = 0;
+
+  block_index = 0;
+  block_used  = 0;
 }
 
 } // namespace ledger
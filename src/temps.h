@@ -44,37 +44,54 @@
 
 namespace ledger {
 
-class temporaries_t
+class temporaries_t : public noncopyable
 {
-  optional<std::list<xact_t> >    xact_temps;
-  optional<std::list<post_t> >    post_temps;
-  optional<std::list<account_t> > acct_temps;
+  // Temporaries are constructed in blocks of memory which are kept until
+  // the temporaries_t itself is destroyed, so that clear() need only run
+  // their destructors and start again at the first block.
+  enum { BLOCK_SIZE = 64 * 1024 };
+
+  std::vector<char *> blocks;
+  std::size_t         block_index;
+  std::size_t         block_used;
+
+  std::vector<xact_t *>    xact_temps;
+  std::vector<post_t *>    post_temps;
+  std::vector<account_t *> acct_temps;
+
+  // Temporary accounts are numbered after the accounts of the tree they
+  // are added to, counting from there again once cleared.
+  std::size_t acct_ids;
+
+  void * allocate(std::size_t size, std::size_t alignment);
+
+  template <typename T>
+  void * allocate() {
+    return allocate(sizeof(T), boost::alignment_of<T>::value);
+  }
 
 public:
-  temporaries_t() {
+  temporaries_t() : block_index(0), block_used(0), acct_ids(0) {
     TRACE_CTOR(temporaries_t, "");
   }
-  ~temporaries_t() {
-    TRACE_DTOR(temporaries_t);
-    clear();
-  }
+  ~temporaries_t();
 
   xact_t&    copy_xact(xact_t& origin);
   xact_t&    create_xact();
   xact_t&    last_xact() {
-    return xact_temps->back();
+    return *xact_temps.back();
   }
   post_t&    copy_post(post_t& origin, xact_t& xact,
                        account_t * account = NULL);
   post_t&    create_post(xact_t& xact, account_t * account,
                          bool bidir_link = true);
   post_t&    last_post() {
-    return post_temps->back();
+    return *post_temps.back();
   }
   account_t& create_account(const string& name   = "",
                             account_t *   parent = NULL);
   account_t& last_account() {
-    return acct_temps->back();
+    return *acct_temps.back();
   }
 
   void clear();
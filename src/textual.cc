@@ -69,15 +69,312 @@ namespace {
       : label(_label), value(rate) {}
   };
 
+  path include_filename(const path& including_file, const char * line)
+  {
+    if (line[0] != '/' && line[0] != '\\' && line[0] != '~') {
+      path parent_path = including_file.parent_path();
+      if (parent_path.empty())
+        return path(string(".")) / line;
+      else
+        return parent_path / line;
+    }
+    return line;
+  }
+
+  /**
+   * @brief Hands out the lines of a journal file without copying them.
+   *
+   * Regular files are mapped privately into memory, so that each line can
+   * be terminated in place and handed to the parser directly; any other
+   * stream is read into a buffer once.  Line boundaries are found with
+   * memchr, which scans a word or vector at a time.  There is no limit on
+   * the length of a line.
+   */
+  class line_reader_t : public noncopyable
+  {
+    boost::iostreams::mapped_file mapping;
+    string                        buffer;
+    string                        last_line;
+    char *                        cur;
+    char *                        end;
+    istream_pos_type              start_pos;
+
+  public:
+    explicit line_reader_t(parse_context_t& context)
+      : cur(NULL), end(NULL), start_pos(0) {
+      std::istream& in(*context.stream.get());
+
+      istream_pos_type pos = in.tellg();
+      if (pos != istream_pos_type(-1))
+        start_pos = pos;
+
+      if (pos == istream_pos_type(0) && ! context.pathname.empty() &&
+          dynamic_cast<ifstream *>(context.stream.get()) &&
+          is_regular_file(context.pathname) &&
+          file_size(context.pathname) > 0) {
+        try {
+          boost::iostreams::mapped_file_params params;
+          params.path  = context.pathname.string();
+          params.flags = boost::iostreams::mapped_file::priv;
+          mapping.open(params);
+          cur = mapping.data();
+          end = cur + mapping.size();
+          return;
+        }
+        catch (const std::exception&) {
+          // Fall back to reading the stream below
+        }
+      }
+
+      if (in.good())
+        buffer.assign(std::istreambuf_iterator<char>(in),
+                      std::istreambuf_iterator<char>());
+      if (! buffer.empty()) {
+        cur = &buffer[0];
+        end = cur + buffer.length();
+      }
+    }
+
+    istream_pos_type position() const {
+      return start_pos;
+    }
+    bool at_end() const {
+      return cur == end;
+    }
+    int peek() const {
+      return cur == end ? EOF : *cur;
+    }
+
+    // Returns the next line, terminated in place, and its length without
+    // the newline.  CONSUMED receives the number of bytes read.
+    char * read_line(std::streamsize& len, std::streamsize& consumed) {
+      assert(cur != end);
+
+      char * beg  = cur;
+      char * line = cur;
+      char * nl   = static_cast<char *>
+        (std::memchr(cur, '\n', static_cast<std::size_t>(end - cur)));
+      if (nl) {
+        *nl = '\0';
+        cur = nl + 1;
+        len = nl - line;
+      } else {
+        // The last line has no newline, and no room after it for a
+        // terminator, so it alone is copied.
+        last_line.assign(line, end);
+        cur  = end;
+        len  = static_cast<std::streamsize>(last_line.length());
+        line = &last_line[0];
+      }
+      consumed = cur - beg;
+      return line;
+    }
+  };
+
+  /**
+   * @brief Reads included journal files ahead of the parser.
+   *
+   * With --parallel-includes, every file read by the textual parser is
+   * scanned for literal "include" directives, and the files they name
+   * are read into memory by a pool of worker threads (which scan them in
+   * turn).  By the time the parser reaches an include directive, the
+   * file's contents are usually waiting for it.
+   *
+   * Only reading and scanning happen off the main thread.  Parsing itself
+   * remains serial and in file order, since the commodity pool, the
+   * account tree and the current epoch are shared by every file and are
+   * not synchronized.  The results are therefore identical to a serial
+   * read, including sequence numbers and error messages.
+   */
+  class include_prefetcher_t : public noncopyable
+  {
+    enum state_t { QUEUED, LOADING, LOADED };
+
+    struct entry_t {
+      state_t            state;
+      bool               scan_only;
+      shared_ptr<string> contents;
+      entry_t() : state(QUEUED), scan_only(false) {}
+    };
+
+    typedef std::map<string, entry_t> entries_map;
+
+    std::mutex               mutex;
+    std::condition_variable  work_ready;
+    std::condition_variable  file_ready;
+    std::deque<path>         queue;
+    entries_map              entries;
+    std::vector<std::thread> workers;
+    bool                     stopping;
+
+  public:
+    include_prefetcher_t() : stopping(false) {
+      std::size_t threads = std::thread::hardware_concurrency();
+      if (threads == 0)
+        threads = 1;
+      for (std::size_t i = 0; i < threads; i++)
+        workers.push_back(std::thread(&include_prefetcher_t::worker, this));
+    }
+    ~include_prefetcher_t() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      work_ready.notify_all();
+      foreach (std::thread& thread, workers)
+        thread.join();
+    }
+
+    void schedule(const path& filename, const bool scan_only = false) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::pair<entries_map::iterator, bool> result =
+          entries.insert(entries_map::value_type(filename.string(),
+                                                 entry_t()));
+        if (! result.second)
+          return;
+        (*result.first).second.scan_only = scan_only;
+        queue.push_back(filename);
+      }
+      work_ready.notify_one();
+    }
+
+    // Schedule the files FILENAME includes, without keeping its own
+    // contents.  This is used for the top-level file, which the parser
+    // opens itself.
+    void schedule_includes(const path& filename) {
+      schedule(filename, true);
+    }
+
+    // Returns a stream over the contents of FILENAME, waiting for a
+    // worker if the file is being read right now, or reading it here if
+    // no worker has gotten to it yet.  A null pointer means the file
+    // could not be read, and the caller should open it the usual way so
+    // that any error is reported as before.
+    shared_ptr<std::istream> open(const path& filename) {
+      shared_ptr<string> contents;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        entries_map::iterator i = entries.find(filename.string());
+        if (i != entries.end() && ! (*i).second.scan_only &&
+            (*i).second.state != QUEUED) {
+          while ((*i).second.state == LOADING)
+            file_ready.wait(lock);
+          contents = (*i).second.contents;
+          entries.erase(i);
+        } else {
+          if (i != entries.end() && (*i).second.state == QUEUED) {
+            queue.erase(std::find(queue.begin(), queue.end(), filename));
+            entries.erase(i);
+          }
+          lock.unlock();
+          contents = load(filename);
+        }
+      }
+      if (! contents)
+        return shared_ptr<std::istream>();
+      return shared_ptr<std::istream>(new std::istringstream(*contents));
+    }
+
+  private:
+    void worker() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        while (! stopping && queue.empty())
+          work_ready.wait(lock);
+        if (stopping)
+          return;
+
+        path filename = queue.front();
+        queue.pop_front();
+        entries[filename.string()].state = LOADING;
+
+        lock.unlock();
+        shared_ptr<string> contents = load(filename);
+        lock.lock();
+
+        entries_map::iterator i = entries.find(filename.string());
+        if ((*i).second.scan_only) {
+          entries.erase(i);
+        } else {
+          (*i).second.state    = LOADED;
+          (*i).second.contents = contents;
+          file_ready.notify_all();
+        }
+      }
+    }
+
+    shared_ptr<string> load(const path& filename) {
+      shared_ptr<string> contents;
+      try {
+        // Directories and the like are left to the caller, which
+        // reports them as unreadable journal files.
+        if (! is_regular_file(filename))
+          return contents;
+
+        std::ifstream in(filename.string().c_str(), std::ios::binary);
+        if (! in)
+          return contents;
+        contents.reset(new string(std::istreambuf_iterator<char>(in),
+                                  std::istreambuf_iterator<char>()));
+        if (in.bad())
+          return shared_ptr<string>();
+      }
+      catch (...) {
+        return shared_ptr<string>();
+      }
+      scan(*contents, filename);
+      return contents;
+    }
+
+    // Look for top-level include directives naming a single file.  Globs
+    // and home-relative paths are left for the parser to expand, since
+    // that involves state which is not safe to touch from a worker.
+    void scan(const string& contents, const path& filename) {
+      string::size_type beg = 0;
+      while (beg < contents.length()) {
+        string::size_type end = contents.find('\n', beg);
+        if (end == string::npos)
+          end = contents.length();
+
+        const char * p = contents.c_str() + beg;
+        if (*p == '!' || *p == '@')
+          p++;
+        if (std::strncmp(p, "include", 7) == 0 &&
+            (p[7] == ' ' || p[7] == '\t')) {
+          string::size_type arg = (p + 7) - contents.c_str();
+          while (arg < end && std::isspace(contents[arg]))
+            arg++;
+          string::size_type last = end;
+          while (last > arg && std::isspace(contents[last - 1]))
+            last--;
+
+          string name(contents, arg, last - arg);
+          if (! name.empty() && name[0] != '~' &&
+              name.find_first_of("*?[\\") == string::npos) {
+            try {
+              path included = include_filename(filename, name.c_str());
+              included.normalize();
+              schedule(included);
+            }
+            catch (...) {}
+          }
+        }
+        beg = end + 1;
+      }
+    }
+  };
+
   class instance_t : public noncopyable, public scope_t
   {
   public:
     parse_context_stack_t&   context_stack;
     parse_context_t&         context;
-    std::istream&            in;
+    line_reader_t            reader;
     instance_t *             parent;
     std::list<application_t> apply_stack;
     bool                     no_assertions;
+    include_prefetcher_t *   prefetcher;
 #if defined(TIMELOG_SUPPORT)
     time_log_t               timelog;
 #endif
@@ -87,8 +384,10 @@ namespace {
                instance_t *           _parent = NULL,
                const bool             _no_assertions = false)
       : context_stack(_context_stack), context(_context),
-        in(*context.stream.get()), parent(_parent),
-        no_assertions(_no_assertions), timelog(context) {}
+        reader(context), parent(_parent),
+        no_assertions(_no_assertions),
+        prefetcher(_parent ? _parent->prefetcher : NULL),
+        timelog(context) {}
 
     virtual string description() {
       return _("textual parser");
@@ -125,13 +424,11 @@ namespace {
     std::streamsize read_line(char *& line);
 
     bool peek_whitespace_line() {
-      return (in.good() && ! in.eof() &&
-              (in.peek() == ' ' || in.peek() == '\t'));
+      return reader.peek() == ' ' || reader.peek() == '\t';
     }
 #if HAVE_BOOST_PYTHON
     bool peek_blank_line() {
-      return (in.good() && ! in.eof() &&
-              (in.peek() == '\n' || in.peek() == '\r'));
+      return reader.peek() == '\n' || reader.peek() == '\r';
     }
 #endif
 
@@ -239,15 +536,15 @@ void instance_t::parse()
 
   TRACE_START(instance_parse, 1, "Done parsing file " << context.pathname);
 
-  if (! in.good() || in.eof())
+  if (reader.at_end())
     return;
 
   context.linenum  = 0;
-  context.curr_pos = in.tellg();
+  context.curr_pos = reader.position();
 
   bool error_flag = false;
 
-  while (in.good() && ! in.eof()) {
+  while (! reader.at_end()) {
     try {
       read_next_directive(error_flag);
     }
@@ -299,36 +596,27 @@ void instance_t::parse()
 
 std::streamsize instance_t::read_line(char *& line)
 {
-  assert(in.good());
-  assert(! in.eof());           // no one should call us in that case
+  assert(! reader.at_end());    // no one should call us in that case
 
   context.line_beg_pos = context.curr_pos;
 
   check_for_signal();
 
-  in.getline(context.linebuf, parse_context_t::MAX_LINE);
-  std::streamsize len = in.gcount();
-
-  if (len > 0) {
-    context.linenum++;
+  std::streamsize len, consumed;
+  line = reader.read_line(len, consumed);
 
-    context.curr_pos  = context.line_beg_pos;
-    context.curr_pos += len;
+  context.linenum++;
+  context.curr_pos += consumed;
 
-    if (context.linenum == 0 && utf8::is_bom(context.linebuf)) {
-      line = &context.linebuf[3];
-      len -= 3;
-    } else {
-      line = context.linebuf;
-    }
+  if (context.linenum == 1 && len >= 3 && utf8::is_bom(line)) {
+    line += 3;
+    len  -= 3;
+  }
 
-    --len;
-    while (len > 0 && std::isspace(line[len - 1])) // strip trailing whitespace
-      line[--len] = '\0';
+  while (len > 0 && std::isspace(line[len - 1])) // strip trailing whitespace
+    line[--len] = '\0';
 
-    return len;
-  }
-  return 0;
+  return len;
 }
 
 void instance_t::read_next_directive(bool& error_flag)
@@ -438,9 +726,14 @@ void instance_t::read_next_directive(bool& error_flag)
 
 void instance_t::clock_in_directive(char * line, bool capitalized)
 {
+  // An open clock-in is closed at the current time when parsing ends.
+  context.journal->cacheable = false;
+
   string datetime(line, 2, 19);
 
-  char * p   = skip_ws(line + 22);
+  // The account and payee are optional; never look past the end of the
+  // line, which is followed directly by the rest of the file.
+  char * p   = skip_ws(line + std::min(std::strlen(line), std::size_t(22)));
   char * n   = next_element(p, true);
   char * end = n ? next_element(n, true) : NULL;
 
@@ -469,7 +762,7 @@ void instance_t::clock_out_directive(char * line, bool capitalized)
 {
   string datetime(line, 2, 19);
 
-  char * p = skip_ws(line + 22);
+  char * p = skip_ws(line + std::min(std::strlen(line), std::size_t(22)));
   char * n = next_element(p, true);
   char * end = n ? next_element(n, true) : NULL;
 
@@ -487,7 +780,7 @@ void instance_t::clock_out_directive(char * line, bool capitalized)
   position.sequence = context.sequence++;
 
   time_xact_t event(position, parse_datetime(datetime), capitalized,
-                    p ? top_account()->find_account(p) : NULL,
+                    *p ? top_account()->find_account(p) : NULL,
                     n ? n : "",
                     end ? end : "");
 
@@ -516,6 +809,7 @@ void instance_t::price_conversion_directive(char * line)
     *p++ = '\0';
     amount_t::parse_conversion(line + 1, p);
   }
+  context.journal->cacheable = false;
 }
 
 void instance_t::price_xact_directive(char * line)
@@ -549,6 +843,8 @@ void instance_t::option_directive(char * line)
   if (! process_option(context.pathname.string(), line + 2, *context.scope,
                        p, line))
     throw_(option_error, _f("Illegal option --%1%") % (line + 2));
+
+  context.journal->cacheable = false;
 }
 
 void instance_t::automated_xact_directive(char * line)
@@ -714,25 +1010,10 @@ void instance_t::xact_directive(char * line, std::streamsize len)
 
 void instance_t::include_directive(char * line)
 {
-  path filename;
-
   DEBUG("textual.include", "include: " << line);
+  DEBUG("textual.include", "parent file path: " << context.pathname);
 
-  if (line[0] != '/' && line[0] != '\\' && line[0] != '~') {
-    DEBUG("textual.include", "received a relative path");
-    DEBUG("textual.include", "parent file path: " << context.pathname);
-    path parent_path = context.pathname.parent_path();
-    if (parent_path.empty()) {
-      filename = path(string(".")) / line;
-    } else {
-      filename = parent_path / line;
-      DEBUG("textual.include", "normalized path: " << filename.string());
-    }
-  } else {
-    filename = line;
-  }
-
-  filename = resolve_path(filename);
+  path filename = resolve_path(include_filename(context.pathname, line));
   DEBUG("textual.include", "resolved path: " << filename.string());
 
   mask_t glob;
@@ -748,7 +1029,7 @@ void instance_t::include_directive(char * line)
   glob.assign_glob('^' + filename.leaf() + '$');
 #endif // BOOST_VERSION >= 103700
 
-  bool files_found = false;
+  std::list<path> files;
   if (exists(parent_path)) {
     filesystem::directory_iterator end;
     for (filesystem::directory_iterator iter(parent_path);
@@ -769,53 +1050,69 @@ void instance_t::include_directive(char * line)
 #else // BOOST_VERSION >= 103700
         string base = (*iter).leaf();
 #endif // BOOST_VERSION >= 103700
-        if (glob.match(base)) {
-          journal_t *  journal  = context.journal;
-          account_t *  master   = top_account();
-          scope_t *    scope    = context.scope;
-          std::size_t& errors   = context.errors;
-          std::size_t& count    = context.count;
-          std::size_t& sequence = context.sequence;
-
-          DEBUG("textual.include", "Including: " << *iter);
-          DEBUG("textual.include", "Master account: " << master->fullname());
-
-          context_stack.push(*iter);
-
-          context_stack.get_current().journal = journal;
-          context_stack.get_current().master  = master;
-          context_stack.get_current().scope   = scope;
-          try {
-            instance_t instance(context_stack, context_stack.get_current(),
-                                this, no_assertions);
-            instance.apply_stack.push_front(application_t("account", master));
-            instance.parse();
-          }
-          catch (...) {
-            errors   += context_stack.get_current().errors;
-            count    += context_stack.get_current().count;
-            sequence += context_stack.get_current().sequence;
-
-            context_stack.pop();
-            throw;
-          }
-
-          errors   += context_stack.get_current().errors;
-          count    += context_stack.get_current().count;
-          sequence += context_stack.get_current().sequence;
-
-          context_stack.pop();
-
-          files_found = true;
-        }
+        if (glob.match(base))
+          files.push_back(*iter);
       }
     }
   }
 
-  if (! files_found)
+  if (files.empty())
     throw_(std::runtime_error,
            _f("File to include was not found: %1%") % filename);
 
+  // When a glob matches several files, let the workers read all of them
+  // while we parse the first.
+  if (prefetcher && files.size() > 1)
+    foreach (const path& pathname, files)
+      prefetcher->schedule(pathname);
+
+  foreach (const path& pathname, files) {
+    journal_t *  journal  = context.journal;
+    account_t *  master   = top_account();
+    scope_t *    scope    = context.scope;
+    std::size_t& errors   = context.errors;
+    std::size_t& count    = context.count;
+    std::size_t& sequence = context.sequence;
+
+    DEBUG("textual.include", "Including: " << pathname);
+    DEBUG("textual.include", "Master account: " << master->fullname());
+
+    shared_ptr<std::istream> stream;
+    if (prefetcher)
+      stream = prefetcher->open(pathname);
+    if (stream) {
+      context_stack.push(stream, pathname.parent_path());
+      context_stack.get_current().pathname = pathname;
+    } else {
+      context_stack.push(pathname);
+    }
+
+    context_stack.get_current().journal = journal;
+    context_stack.get_current().master  = master;
+    context_stack.get_current().scope   = scope;
+    try {
+      instance_t instance(context_stack, context_stack.get_current(),
+                          this, no_assertions);
+      instance.apply_stack.push_front(application_t("account", master));
+      instance.parse();
+    }
+    catch (...) {
+      errors   += context_stack.get_current().errors;
+      count    += context_stack.get_current().count;
+      sequence += context_stack.get_current().sequence;
+
+      context_stack.pop();
+      throw;
+    }
+
+    errors   += context_stack.get_current().errors;
+    count    += context_stack.get_current().count;
+    sequence += context_stack.get_current().sequence;
+
+    context_stack.pop();
+
+    journal->sources.push_back(journal_t::fileinfo_t(pathname));
+  }
 }
 
 void instance_t::apply_directive(char * line)
@@ -968,6 +1265,7 @@ void instance_t::account_directive(char * line)
       // can be used to override definitions within the account.
       bind_scope_t bound_scope(*context.scope, *account);
       expr_t(b).calc(bound_scope);
+      context.journal->cacheable = false;
     }
     else if (keyword == "note") {
       account->note = b;
@@ -978,7 +1276,7 @@ void instance_t::account_directive(char * line)
     context.journal->auto_xacts.push_back(ae.get());
 
     ae->journal       = context.journal;
-    ae->pos->end_pos  = in.tellg();
+    ae->pos->end_pos  = context.curr_pos;
     ae->pos->end_line = context.linenum;
 
     ae.release();
@@ -1166,10 +1464,12 @@ void instance_t::eval_directive(char * line)
 {
   expr_t expr(line);
   expr.calc(*context.scope);
+  context.journal->cacheable = false;
 }
 
 void instance_t::assert_directive(char * line)
 {
+  context.journal->cacheable = false;
   expr_t expr(line);
   if (! expr.calc(*context.scope).to_boolean())
     throw_(parse_error, _f("Assertion failed: %1%") % line);
@@ -1177,6 +1477,7 @@ void instance_t::assert_directive(char * line)
 
 void instance_t::check_directive(char * line)
 {
+  context.journal->cacheable = false;
   expr_t expr(line);
   if (! expr.calc(*context.scope).to_boolean())
     context.warning(_f("Check failed: %1%") % line);
@@ -1189,7 +1490,7 @@ void instance_t::value_directive(char * line)
 
 void instance_t::comment_directive(char * line)
 {
-  while (in.good() && ! in.eof()) {
+  while (! reader.at_end()) {
     if (read_line(line) > 0) {
       std::string buf(line);
       if (starts_with(buf, "end comment") || starts_with(buf, "end test"))
@@ -1205,6 +1506,7 @@ void instance_t::import_directive(char * line)
   string module_name(line);
   trim(module_name);
   python_session->import_option(module_name);
+  context.journal->cacheable = false;
 }
 
 void instance_t::python_directive(char * line)
@@ -1245,6 +1547,7 @@ void instance_t::python_directive(char * line)
   python_session->main_module->define_global
     ("journal", python::object(python::ptr(context.journal)));
   python_session->eval(script.str(), python_interpreter_t::PY_EVAL_MULTI);
+  context.journal->cacheable = false;
 }
 
 #else
@@ -1265,9 +1568,18 @@ void instance_t::python_directive(char *)
 
 bool instance_t::general_directive(char * line)
 {
-  char buf[8192];
-
-  std::strcpy(buf, line);
+  // The directive is split in place, so work on a copy of the line.
+  // Most lines fit on the stack.
+  char              linebuf[8192];
+  std::vector<char> longbuf;
+  char *            buf     = linebuf;
+  std::size_t       buf_len = std::strlen(line);
+  if (buf_len < sizeof(linebuf)) {
+    std::memcpy(linebuf, line, buf_len + 1);
+  } else {
+    longbuf.assign(line, line + buf_len + 1);
+    buf = &longbuf[0];
+  }
 
   char * p   = buf;
   char * arg = next_element(buf);
@@ -1395,6 +1707,7 @@ bool instance_t::general_directive(char * line)
     call_scope_t args(*this);
     args.push_back(string_value(p));
     op->as_function()(args);
+    context.journal->cacheable = false;
     return true;
   }
 
@@ -1418,8 +1731,18 @@ post_t * instance_t::parse_post(char *          line,
   post->pos->beg_line = context.linenum;
   post->pos->sequence = context.sequence++;
 
-  char buf[parse_context_t::MAX_LINE + 1];
-  std::strcpy(buf, line);
+  // Keep a copy of the line for error messages, since parsing modifies it.
+  // Most lines fit on the stack.
+  char         linebuf[parse_context_t::MAX_LINE + 1];
+  string       longbuf;
+  const char * buf     = linebuf;
+  std::size_t  buf_len = std::strlen(line);
+  if (buf_len <= parse_context_t::MAX_LINE) {
+    std::memcpy(linebuf, line, buf_len + 1);
+  } else {
+    longbuf.assign(line, buf_len);
+    buf = longbuf.c_str();
+  }
   std::streamsize beg = 0;
 
   try {
@@ -1494,12 +1817,14 @@ post_t * instance_t::parse_post(char *          line,
     beg = static_cast<std::streamsize>(next - line);
     ptristream stream(next, static_cast<std::size_t>(len - beg));
 
-    if (*next != '(')           // indicates a value expression
+    if (*next != '(') {         // indicates a value expression
       post->amount.parse(stream, PARSE_NO_REDUCE);
-    else
+    } else {
       parse_amount_expr(stream, *context.scope, *post.get(), post->amount,
                         PARSE_NO_REDUCE | PARSE_SINGLE | PARSE_NO_ASSIGN,
                         defer_expr, &post->amount_expr);
+      context.journal->cacheable = false;
+    }
 
     DEBUG("textual.parse", "line " << context.linenum << ": "
           << "post amount = " << post->amount);
@@ -1566,11 +1891,13 @@ post_t * instance_t::parse_post(char *          line,
           beg = static_cast<std::streamsize>(p - line);
           ptristream cstream(p, static_cast<std::size_t>(len - beg));
 
-          if (*p != '(')                // indicates a value expression
+          if (*p != '(') {              // indicates a value expression
             post->cost->parse(cstream, PARSE_NO_MIGRATE);
-          else
+          } else {
             parse_amount_expr(cstream, *context.scope, *post.get(), *post->cost,
                               PARSE_NO_MIGRATE | PARSE_SINGLE | PARSE_NO_ASSIGN);
+            context.journal->cacheable = false;
+          }
 
           if (post->cost->sign() < 0)
             throw parse_error(_("A posting's cost may not be negative"));
@@ -1625,12 +1952,14 @@ post_t * instance_t::parse_post(char *          line,
       beg = static_cast<std::streamsize>(p - line);
       ptristream stream(p, static_cast<std::size_t>(len - beg));
 
-      if (*p != '(')            // indicates a value expression
+      if (*p != '(') {          // indicates a value expression
         post->assigned_amount->parse(stream, PARSE_NO_MIGRATE);
-      else
+      } else {
         parse_amount_expr(stream, *context.scope, *post.get(),
                           *post->assigned_amount,
                           PARSE_SINGLE | PARSE_NO_MIGRATE);
+        context.journal->cacheable = false;
+      }
 
       if (post->assigned_amount->is_null()) {
         if (post->amount.is_null())
@@ -1903,6 +2232,7 @@ xact_t * instance_t::parse_xact(char *          line,
       p = skip_ws(&p[*p == 'a' ? 6 : (*p == 'c' ? 5 : 4)]);
       expr_t expr(p);
       bind_scope_t bound_scope(*context.scope, *item);
+      context.journal->cacheable = false;
       if (c == 'e') {
         expr.calc(bound_scope);
       }
@@ -1988,8 +2318,20 @@ std::size_t journal_t::read_textual(parse_context_stack_t& context_stack)
 {
   TRACE_START(parsing_total, 1, "Total time spent parsing text:");
   {
+    unique_ptr<include_prefetcher_t> prefetcher;
+    if (parallel_includes) {
+      prefetcher.reset(new include_prefetcher_t);
+
+      // The top-level file is read by the parser as usual; only the
+      // files it includes are fetched ahead of time.
+      parse_context_t& current(context_stack.get_current());
+      if (! current.pathname.empty())
+        prefetcher->schedule_includes(current.pathname);
+    }
+
     instance_t instance(context_stack, context_stack.get_current(), NULL,
                         checking_style == journal_t::CHECK_PERMISSIVE);
+    instance.prefetcher = prefetcher.get();
     instance.apply_stack.push_front
       (application_t("account", context_stack.get_current().master));
     instance.parse();
@@ -213,6 +213,65 @@ inline string operator+(const char * left, const string& right) {
 
 /*@}*/
 
+/**
+ * @name Pooled storage
+ */
+/*@{*/
+
+namespace ledger {
+
+/**
+ * @brief Chunked storage for many objects of one size.
+ *
+ * Blocks of object_size bytes are carved out of large chunks in order and
+ * recycled through a free list, so objects allocated together lie
+ * together in memory.  Chunks are never given back to the heap.  The pool
+ * holds only plain data, so that a static one is usable before static
+ * constructors run and after static destructors have.
+ */
+template <std::size_t object_size>
+struct fixed_pool_t
+{
+  static const std::size_t block_size = (object_size + 15) & ~std::size_t(15);
+  static const std::size_t chunk_size = 64 * 1024;
+
+  struct block_t { block_t * next; };
+
+  block_t * free_list;
+  char *    chunk_cur;
+  char *    chunk_end;
+
+  void * allocate() {
+    if (block_t * block = free_list) {
+      free_list = block->next;
+      return block;
+    }
+    if (static_cast<std::size_t>(chunk_end - chunk_cur) < block_size) {
+      chunk_cur = static_cast<char *>(std::malloc(chunk_size));
+      if (! chunk_cur) {
+        chunk_end = NULL;
+        return NULL;
+      }
+      chunk_end = chunk_cur + chunk_size;
+    }
+    void * block = chunk_cur;
+    chunk_cur += block_size;
+    return block;
+  }
+
+  void deallocate(void * ptr) {
+    if (! ptr)
+      return;
+    block_t * block = static_cast<block_t *>(ptr);
+    block->next     = free_list;
+    free_list       = block;
+  }
+};
+
+} // namespace ledger
+
+/*@}*/
+
 /**
  * @name Tracing and logging
  */
@@ -465,6 +465,30 @@ bool xact_base_t::verify()
   return true;
 }
 
+namespace {
+  // Every transaction read from a journal is allocated here, so that they lie
+  // together in the order they were parsed rather than being scattered
+  // through the heap.
+  fixed_pool_t<sizeof(xact_t)> xact_pool;
+}
+
+void * xact_t::operator new(std::size_t size)
+{
+  if (size != sizeof(xact_t))
+    return ::operator new(size);
+  if (void * ptr = xact_pool.allocate())
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void xact_t::operator delete(void * ptr, std::size_t size)
+{
+  if (size != sizeof(xact_t))
+    ::operator delete(ptr);
+  else
+    xact_pool.deallocate(ptr);
+}
+
 xact_t::xact_t(const xact_t& e)
   : xact_base_t(e), code(e.code), payee(e.payee)
 #if DOCUMENT_MODEL
@@ -526,6 +550,8 @@ namespace {
     }
     return true;
   }
+
+  symbol_cache_t xact_functions;
 }
 
 expr_t::ptr_op_t xact_t::lookup(const symbol_t::kind_t kind,
@@ -534,6 +560,16 @@ expr_t::ptr_op_t xact_t::lookup(const symbol_t::kind_t kind,
   if (kind != symbol_t::FUNCTION)
     return item_t::lookup(kind, name);
 
+  expr_t::ptr_op_t def;
+  if (! xact_functions.find(name, def)) {
+    def = lookup_function(name);
+    xact_functions.remember(name, def);
+  }
+  return def;
+}
+
+expr_t::ptr_op_t xact_t::lookup_function(const string& name)
+{
   switch (name[0]) {
   case 'a':
     if (name == "any")
@@ -558,7 +594,7 @@ expr_t::ptr_op_t xact_t::lookup(const symbol_t::kind_t kind,
     break;
   }
 
-  return item_t::lookup(kind, name);
+  return item_t::lookup(symbol_t::FUNCTION, name);
 }
 
 bool xact_t::valid() const
@@ -577,50 +613,6 @@ bool xact_t::valid() const
   return true;
 }
 
-namespace {
-  bool post_pred(expr_t::ptr_op_t op, post_t& post)
-  {
-    switch (op->kind) {
-    case expr_t::op_t::VALUE:
-      return op->as_value().to_boolean();
-
-    case expr_t::op_t::O_MATCH:
-      if (op->left()->kind == expr_t::op_t::IDENT &&
-          op->left()->as_ident() == "account" &&
-          op->right()->kind == expr_t::op_t::VALUE &&
-          op->right()->as_value().is_mask())
-        return op->right()->as_value().as_mask()
-          .match(post.reported_account()->fullname());
-      else
-        break;
-
-    case expr_t::op_t::O_EQ:
-      return post_pred(op->left(), post) == post_pred(op->right(), post);
-
-    case expr_t::op_t::O_NOT:
-      return ! post_pred(op->left(), post);
-
-    case expr_t::op_t::O_AND:
-      return post_pred(op->left(), post) && post_pred(op->right(), post);
-
-    case expr_t::op_t::O_OR:
-      return post_pred(op->left(), post) || post_pred(op->right(), post);
-
-    case expr_t::op_t::O_QUERY:
-      if (post_pred(op->left(), post))
-        return post_pred(op->right()->left(), post);
-      else
-        return post_pred(op->right()->right(), post);
-
-    default:
-      break;
-    }
-
-    throw_(calc_error, _("Unhandled operator"));
-    return false;
-  }
-}
-
 static string apply_format(const string& str, scope_t& scope)
 {
   if (contains(str, "%(")) {
@@ -647,38 +639,14 @@ void auto_xact_t::extend_xact(xact_base_t& xact, parse_context_t& context)
 
     bind_scope_t bound_scope(*scope_t::default_scope, *initial_post);
 
-    bool matches_predicate = false;
-    if (try_quick_match) {
-      try {
-        bool found_memoized_result = false;
-        if (! memoized_results.empty()) {
-          std::map<string, bool>::iterator i =
-            memoized_results.find(initial_post->account->fullname());
-          if (i != memoized_results.end()) {
-            found_memoized_result = true;
-            matches_predicate = (*i).second;
-          }
-        }
+    // Account masks are tried once per account and the results kept by
+    // the account, so most automated transactions, which match only
+    // against account names, cost a few bit tests per posting.
+    if (! post_predicate)
+      post_predicate = post_predicate_t(predicate);
 
-        // Since the majority of people who use automated transactions simply
-        // match against account names, try using a *much* faster version of
-        // the predicate evaluator.
-        if (! found_memoized_result) {
-          matches_predicate = post_pred(predicate.get_op(), *initial_post);
-          memoized_results.insert
-            (std::pair<string, bool>(initial_post->account->fullname(),
-                                     matches_predicate));
-        }
-      }
-      catch (...) {
-        DEBUG("xact.extend.fail",
-              "The quick matcher failed, going back to regular eval");
-        try_quick_match   = false;
-        matches_predicate = predicate(bound_scope);
-      }
-    } else {
-      matches_predicate = predicate(bound_scope);
-    }
+    bool matches_predicate = (*post_predicate)(*initial_post,
+                                               *scope_t::default_scope);
 
     if (matches_predicate) {
       if (deferred_notes) {
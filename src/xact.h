@@ -112,6 +112,14 @@ public:
     TRACE_DTOR(xact_t);
   }
 
+  // Allocated from a pool of transactions, see xact.cc
+  static void * operator new(std::size_t size);
+  static void   operator delete(void * ptr, std::size_t size);
+  static void * operator new(std::size_t, void * place) {
+    return place;
+  }
+  static void   operator delete(void *, void *) {}
+
   virtual string description() {
     if (pos) {
       std::ostringstream buf;
@@ -126,6 +134,7 @@ public:
 
   virtual expr_t::ptr_op_t lookup(const symbol_t::kind_t kind,
                                   const string& name);
+  expr_t::ptr_op_t lookup_function(const string& name);
 
   virtual bool valid() const;
 };
@@ -133,9 +142,8 @@ public:
 class auto_xact_t : public xact_base_t
 {
 public:
-  predicate_t            predicate;
-  bool                   try_quick_match;
-  std::map<string, bool> memoized_results;
+  predicate_t                predicate;
+  optional<post_predicate_t> post_predicate;
 
   optional<expr_t::check_expr_list> check_exprs;
 
@@ -155,17 +163,16 @@ public:
   optional<deferred_notes_list> deferred_notes;
   post_t * active_post;
 
-  auto_xact_t() : try_quick_match(true), active_post(NULL) {
+  auto_xact_t() : active_post(NULL) {
     TRACE_CTOR(auto_xact_t, "");
   }
   auto_xact_t(const auto_xact_t& other)
     : xact_base_t(), predicate(other.predicate),
-      try_quick_match(other.try_quick_match),
       active_post(other.active_post) {
     TRACE_CTOR(auto_xact_t, "copy");
   }
   auto_xact_t(const predicate_t& _predicate)
-    : predicate(_predicate), try_quick_match(true), active_post(NULL)
+    : predicate(_predicate), active_post(NULL)
   {
     TRACE_CTOR(auto_xact_t, "const predicate_t&");
   }
@@ -228,7 +235,7 @@ class period_xact_t : public xact_base_t
   }
 };
 
-typedef std::list<xact_t *>        xacts_list;
+typedef std::vector<xact_t *>      xacts_list;
 typedef std::list<auto_xact_t *>   auto_xacts_list;
 typedef std::list<period_xact_t *> period_xacts_list;
 
@@ -33,6 +33,7 @@ class CheckBaselineTests (CheckOptions):
         'price-exp',
         'revalued-total',
         'seed',
+        'socket',
         'trace',
         'verbose',
         'verify',
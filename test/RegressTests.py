@@ -3,6 +3,7 @@
 import sys
 import os
 import re
+import shutil
 import tempfile
 
 multiproc = False
@@ -39,10 +40,13 @@ class RegressFile(object):
     def __init__(self, filename):
         self.filename = filename
         self.fd = open(self.filename)
+        # A scratch directory of its own, for tests that write files
+        self.tmpdir = tempfile.mkdtemp(prefix='ledger-test')
 
     def transform_line(self, line):
         line = re.sub('\$sourcepath', harness.sourcepath, line)
         line = re.sub('\$FILE', os.path.abspath(self.filename), line)
+        line = re.sub('\$tmpdir', self.tmpdir, line)
         return line
 
     def read_test(self):
@@ -66,7 +70,7 @@ class RegressFile(object):
                     test['command'] = self.transform_line(match.group(1))
                     test['exitcode'] = int(match.group(2))
                 else:
-                    test['command'] = command
+                    test['command'] = self.transform_line(command)
                 in_output = True
 
             elif in_output:
@@ -197,6 +201,7 @@ class RegressFile(object):
 
     def close(self):
         self.fd.close()
+        shutil.rmtree(self.tmpdir)
 
 def do_test(path):
     entry = RegressFile(path)
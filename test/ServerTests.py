@@ -0,0 +1,129 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This script starts ledger with --socket, sends it commands the way any
+# client would, and checks that it reads the journal again once the
+# journal file changes.
+
+from __future__ import print_function
+
+import os
+import sys
+import time
+import socket
+import signal
+import shutil
+import argparse
+import tempfile
+
+from subprocess import Popen
+
+class ServerTests (object):
+  def __init__(self, args):
+    self.ledger  = os.path.abspath(args.ledger)
+    self.tmpdir  = tempfile.mkdtemp(prefix='ledger-server')
+    self.journal = os.path.join(self.tmpdir, 'journal.dat')
+    self.socket  = os.path.join(self.tmpdir, 'ledger.sock')
+    self.errors  = 0
+
+  def write_journal(self, text, mtime):
+    with open(self.journal, 'w') as out:
+      out.write(text)
+    os.utime(self.journal, (mtime, mtime))
+
+  def send(self, command):
+    client = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    client.connect(self.socket)
+    client.sendall((command + '\n').encode())
+    client.shutdown(socket.SHUT_WR)
+    output = b''
+    while True:
+      data = client.recv(4096)
+      if not data: break
+      output += data
+    client.close()
+    return output.decode()
+
+  def check(self, command, expected):
+    output = self.send(command)
+    if output != expected:
+      print("FAILURE in command '%s':" % command)
+      print("  expected: %r" % expected)
+      print("  got:      %r" % output)
+      self.errors += 1
+
+  def main(self):
+    now = time.time()
+    self.write_journal("""
+2012-03-10 KFC
+    Expenses:Food                $20
+    Assets:Cash
+""", now - 10)
+
+    server = Popen([self.ledger, '--args-only', '--columns=80',
+                    '-f', self.journal, '--socket', self.socket])
+    try:
+      for i in range(100):
+        if os.path.exists(self.socket): break
+        time.sleep(0.1)
+
+      self.check('bal --flat',
+                 "                $-20  Assets:Cash\n"
+                 "                 $20  Expenses:Food\n"
+                 "--------------------\n"
+                 "                   0\n")
+
+      # Options given to one command must not carry over to the next
+      self.check('bal --flat Food -V', "                 $20  Expenses:Food\n")
+      self.check('bal --flat Food', "                 $20  Expenses:Food\n")
+
+      self.check('nosuchcommand',
+                 "Error: Unrecognized command 'nosuchcommand'\n")
+
+      self.write_journal("""
+2012-03-10 KFC
+    Expenses:Food                $20
+    Assets:Cash
+
+2012-03-11 KFC
+    Expenses:Food                $15
+    Assets:Cash
+""", now)
+
+      self.check('bal --flat Food', "                 $35  Expenses:Food\n")
+    finally:
+      server.send_signal(signal.SIGINT)
+      status = server.wait()
+
+    if status != 0:
+      print("FAILURE: server exited with status %d" % status)
+      self.errors += 1
+    if os.path.exists(self.socket):
+      print("FAILURE: server did not remove its socket")
+      self.errors += 1
+
+    shutil.rmtree(self.tmpdir)
+    return self.errors
+
+if __name__ == "__main__":
+  def getargs():
+    parser = argparse.ArgumentParser(prog='ServerTests',
+            description='Test serving commands over a socket')
+    parser.add_argument('-l', '--ledger',
+        dest='ledger',
+        type=str,
+        action='store',
+        required=True,
+        help='the path to the ledger executable to test with')
+    parser.add_argument('-s', '--source',
+        dest='source',
+        type=str,
+        action='store',
+        required=True,
+        help='the path to the top level ledger source directory')
+    return parser.parse_args()
+
+  args = getargs()
+  script = ServerTests(args)
+  status = script.main()
+  sys.exit(status)
@@ -1388,6 +1388,35 @@ BOOST_AUTO_TEST_CASE(testCommodityPrinting)
   BOOST_CHECK(x2.valid());
 }
 
+BOOST_AUTO_TEST_CASE(testSmallQuantityOverflow)
+{
+  amount_t x1("999999999999999.999");
+  amount_t x2("0.0001");
+  amount_t x3("-999999999999999.999");
+
+  BOOST_CHECK_EQUAL(amount_t("1999999999999999.998"), x1 + x1);
+  BOOST_CHECK_EQUAL(amount_t("999999999999999.9991"), x1 + x2);
+  BOOST_CHECK_EQUAL(amount_t("-999999999999999.9991"), x3 - x2);
+  BOOST_CHECK_EQUAL(amount_t("999999999999999998000000000000.000001"),
+                    x1 * x1);
+  BOOST_CHECK_EQUAL(x1, - x3);
+  BOOST_CHECK(x1 + x2 > x1);
+  BOOST_CHECK(x3 - x2 < x3);
+  BOOST_CHECK(x1 * 10L > x1 + x2);
+
+  amount_t x4("123456789.123456789");
+  amount_t x5("0.000000001");
+
+  BOOST_CHECK_EQUAL(amount_t("123456789.12345679"), x4 + x5);
+  BOOST_CHECK_EQUAL(amount_t("0.123456789123456789"), x4 * x5);
+
+  BOOST_CHECK(x1.valid());
+  BOOST_CHECK(x2.valid());
+  BOOST_CHECK(x3.valid());
+  BOOST_CHECK(x4.valid());
+  BOOST_CHECK(x5.valid());
+}
+
 #endif // NOT_FOR_PYTHON
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -525,4 +525,43 @@ BOOST_AUTO_TEST_CASE(testForZero)
   BOOST_CHECK(b1.valid());
 }
 
+BOOST_AUTO_TEST_CASE(testManyCommodities)
+{
+  balance_t b0;
+  balance_t b1;
+
+  b0 += amount_t("$ 1");
+  b0 += amount_t("2 EUR");
+  b0 += amount_t("3 CAD");
+  b0 += amount_t("4 DM");
+  b0 += amount_t("5 GBP");
+  b0 += amount_t("$ 6");
+
+  b1 += amount_t("5 GBP");
+  b1 += amount_t("4 DM");
+  b1 += amount_t("3 CAD");
+  b1 += amount_t("2 EUR");
+  b1 += amount_t("$ 7");
+
+  BOOST_CHECK_EQUAL(5, b0.amounts.size());
+  BOOST_CHECK_EQUAL(b0, b1);
+
+  balance_t b2(b0);
+  b2 -= amount_t("3 CAD");
+  b2 -= amount_t("$ 7");
+
+  BOOST_CHECK_EQUAL(3, b2.amounts.size());
+  BOOST_CHECK_EQUAL(5, b0.amounts.size());
+  BOOST_CHECK_EQUAL(b0 - b2, balance_t("$ 7") + amount_t("3 CAD"));
+
+  balance_t::amounts_map::const_iterator i = b0.amounts.begin();
+  for (balance_t::amounts_map::const_iterator j = i + 1;
+       j != b0.amounts.end(); ++i, ++j)
+    BOOST_CHECK(i->first < j->first);
+
+  BOOST_CHECK(b0.valid());
+  BOOST_CHECK(b1.valid());
+  BOOST_CHECK(b2.valid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
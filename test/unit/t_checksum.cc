@@ -0,0 +1,79 @@
+#define BOOST_TEST_DYN_LINK
+//#define BOOST_TEST_MODULE checksum
+#include <boost/test/unit_test.hpp>
+
+#include <system.hh>
+
+#include "checksum.h"
+
+using namespace ledger;
+
+struct checksum_fixture {
+  path index_file;
+
+  checksum_fixture()
+    : index_file(boost::filesystem::temp_directory_path() /
+                 boost::filesystem::unique_path("ledger-%%%%-%%%%.idx")) {}
+
+  ~checksum_fixture() {
+    boost::filesystem::remove(index_file);
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(checksum, checksum_fixture)
+
+BOOST_AUTO_TEST_CASE(testAppendAfterPartialRecord)
+{
+  const string uuid1("3feaa34d12f68e86cd79a614c80dcea884073113");
+  const string uuid2("0123456789abcdef0123456789abcdef01234567");
+  const string uuid3("not a digest");
+
+  checksum_index_t first;
+  first.insert(uuid1, NULL);
+  first.save(index_file);
+
+  checksum_index_t second;
+  std::size_t length = second.load(index_file);
+  BOOST_CHECK_EQUAL(length, boost::filesystem::file_size(index_file));
+  BOOST_CHECK(second.contains(uuid1));
+
+  std::vector<checksum_index_t::key_t> keys;
+  keys.push_back(checksum_index_t::make_key(uuid2));
+  checksum_index_t::append(index_file, length, keys);
+
+  // Leave part of a record behind, as an interrupted run would
+  {
+    ofstream out(index_file, std::ios::out | std::ios::binary |
+                 std::ios::app);
+    out.write("partial", 7);
+  }
+
+  checksum_index_t third;
+  length = third.load(index_file);
+  BOOST_CHECK_EQUAL(length + 7, boost::filesystem::file_size(index_file));
+  BOOST_CHECK_EQUAL(2U, third.size());
+  BOOST_CHECK(third.contains(uuid1));
+  BOOST_CHECK(third.contains(uuid2));
+
+  keys.clear();
+  keys.push_back(checksum_index_t::make_key(uuid3));
+  checksum_index_t::append(index_file, length, keys);
+
+  // Keys appended after the partial record must still be read back
+  checksum_index_t fourth;
+  length = fourth.load(index_file);
+  BOOST_CHECK_EQUAL(length, boost::filesystem::file_size(index_file));
+  BOOST_CHECK_EQUAL(3U, fourth.size());
+  BOOST_CHECK(fourth.contains(uuid1));
+  BOOST_CHECK(fourth.contains(uuid2));
+  BOOST_CHECK(fourth.contains(uuid3));
+}
+
+BOOST_AUTO_TEST_CASE(testLoadMissing)
+{
+  checksum_index_t index;
+  BOOST_CHECK_EQUAL(0U, index.load(index_file));
+  BOOST_CHECK(index.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,10 @@
 #include "predicate.h"
 #include "query.h"
 #include "op.h"
+#include "scope.h"
+#include "account.h"
+#include "xact.h"
+#include "post.h"
 
 using namespace ledger;
 
@@ -331,4 +335,147 @@ BOOST_AUTO_TEST_CASE(testPredicateTokenizer16)
 #endif
 }
 
+namespace {
+  value_t get_ten(call_scope_t&) {
+    return 10L;
+  }
+  value_t get_name(call_scope_t&) {
+    return string_value("Assets:Cash");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testCompiledProgram)
+{
+  symbol_scope_t scope(*scope_t::empty_scope);
+  scope.define(symbol_t::FUNCTION, "ten", WRAP_FUNCTOR(get_ten));
+  scope.define(symbol_t::FUNCTION, "name", WRAP_FUNCTOR(get_name));
+
+  const char * exprs[] = {
+    "ten + 5 * ten",
+    "-ten / 4",
+    "ten > 5 & ten < 20",
+    "ten < 5 | ten == 10",
+    "ten and 0",
+    "!(ten >= 10) ? 1 : ten - 2",
+    "name =~ /cash/",
+    NULL
+  };
+
+  for (const char ** p = exprs; *p; p++) {
+    expr_t expr(*p);
+    expr.compile(scope);
+
+    // The compiled program must agree with walking the compiled tree
+    BOOST_CHECK_EQUAL(expr.get_op()->calc(scope), expr.calc(scope));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testPostPredicate)
+{
+  empty_scope_t empty_scope;
+  account_t     master;
+
+  xact_t full;
+  full._date = parse_date("2012/03/02");
+  full.payee = "Grocer";
+  full.code  = string("101");
+  full.note  = string("weekly");
+
+  xact_t bare;
+  bare._date = parse_date("2012/03/09");
+  bare.payee = "Bare";
+
+  std::vector<post_t *> posts;
+
+  post_t * post = new post_t(master.find_account("Assets:Cash"),
+                             amount_t("$-10.00"), ITEM_NORMAL,
+                             string("lunch"));
+  post->set_state(item_t::CLEARED);
+  post->set_tag("Meal", string_value("lunch"));
+  full.add_post(post);
+  posts.push_back(post);
+
+  post = new post_t(master.find_account("Expenses:Food"),
+                    amount_t("10 AAPL {$1.00}"));
+  full.add_post(post);
+  posts.push_back(post);
+
+  // A null amount, with no code or note on the xact
+  post = new post_t(master.find_account("Expenses:Misc"), POST_VIRTUAL);
+  post->set_state(item_t::PENDING);
+  bare.add_post(post);
+  posts.push_back(post);
+
+  // A compound amount, whose value is a balance
+  post = new post_t(master.find_account("Assets:Cash"), amount_t("$5.00"));
+  post->xdata().add_flags(POST_EXT_COMPOUND);
+  post->xdata().compound_value = amount_t("$5.00");
+  post->xdata().compound_value += amount_t("3 EUR");
+  bare.add_post(post);
+  posts.push_back(post);
+
+  const char * exprs[] = {
+    "account =~ /cash/",
+    "payee =~ /groc/",
+    "code =~ /10/",
+    "note =~ /lunch/",
+    "note =~ /week/",
+    "commodity =~ /AAPL/",
+    "has_tag(/Meal/)",
+    "has_tag(/Meal/, /lun/)",
+    "has_tag(/Meal/, /dinner/)",
+    "cleared",
+    "pending",
+    "uncleared",
+    "actual",
+    "real",
+    "virtual",
+    "date < [2012/03/05]",
+    "date >= [2012/03/05]",
+    "amount > 0",
+    "amount <= 0",
+    "amount == 10",
+    "!(account =~ /food/)",
+    "account =~ /cash/ & amount < 0",
+    "code =~ /1/ | note =~ /nothing/",
+    "cleared ? amount > 0 : payee =~ /bare/",
+    "note or code",
+    "amount or 0",
+    "code",
+    "amount / 0 > 1",
+    NULL
+  };
+
+  for (const char ** p = exprs; *p; p++) {
+    predicate_t      predicate(*p, keep_details_t());
+    post_predicate_t post_predicate(predicate);
+
+    foreach (post_t * tested, posts) {
+      // Both must either succeed with the same answer, or both fail
+      bool expected       = false;
+      bool expected_error = false;
+      try {
+        bind_scope_t bound_scope(empty_scope, *tested);
+        expected = predicate.calc(bound_scope).to_boolean();
+      }
+      catch (const std::exception&) {
+        expected_error = true;
+      }
+
+      bool result       = false;
+      bool result_error = false;
+      try {
+        result = post_predicate(*tested, empty_scope);
+      }
+      catch (const std::exception&) {
+        result_error = true;
+      }
+
+      BOOST_CHECK_MESSAGE(expected_error == result_error &&
+                          expected == result,
+                          *p << " on " << tested->account->fullname());
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()